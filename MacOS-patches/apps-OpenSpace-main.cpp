@@ -34,6 +34,7 @@
 #include <openspace/engine/settings.h>
 #include <openspace/engine/windowdelegate.h>
 #include <openspace/interaction/joystickinputstate.h>
+#include <openspace/interaction/sessionrecordinghandler.h>
 #include <openspace/util/progressbar.h>
 #include <openspace/util/task.h>
 #include <openspace/util/taskloader.h>
@@ -47,7 +48,9 @@
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/logging/visualstudiooutputlog.h>
+#include <ghoul/lua/lua_helper.h>
 #include <ghoul/misc/defer.h>
+#include <ghoul/misc/dictionary.h>
 #include <ghoul/misc/stacktrace.h>
 #ifdef WIN32
 #define GLFW_EXPOSE_NATIVE_WIN32
@@ -58,13 +61,18 @@
 #include <sgct/commandline.h>
 #include <sgct/engine.h>
 #include <sgct/log.h>
+#include <sgct/networkmanager.h>
 #include <sgct/projection/fisheye.h>
 #include <sgct/projection/nonlinearprojection.h>
+#include <sgct/screencapture.h>
+#include <sgct/statisticshistory.h>
+#include <sgct/syncdelta.h>
 #include <sgct/user.h>
 #include <sgct/window.h>
 #include <stb_image.h>
 #include <tracy/Tracy.hpp>
 #include <iostream>
+#include <map>
 #include <string_view>
 
 #ifdef WIN32
@@ -127,6 +135,13 @@ Window* FirstOpenVRWindow = nullptr;
 // run a task
 std::optional<std::string> taskToRun;
 
+// Set from the commandline if the synchronized data is sent as the compressed difference
+// to the previous frame. All nodes of a cluster have to be started with the same value
+std::optional<bool> compressedSync;
+SyncDeltaEncoder syncEncoder;
+SyncDeltaDecoder syncDecoder;
+std::vector<std::byte> syncData;
+
 //
 //  SPOUT-support
 //
@@ -494,6 +509,17 @@ void mainPostSyncPreDrawFunc() {
 
     global::openSpaceEngine->postSynchronizationPreDraw();
 
+    // Frames that are saved while a session recording is played back are rendered
+    // offline, so none of them may be dropped while the capture still runs alongside
+    // the rendering of the next frames. This only changes how the frames are captured.
+    // Frames are not held back until the globes have loaded their tiles, which is left
+    // to the dynamic level of detail of the globes if the playback waits for tiles
+    const bool isSavingFrames =
+        global::sessionRecordingHandler->isSavingFramesDuringPlayback();
+    if (isSavingFrames != sgct::ScreenCapture::isOfflineExport()) {
+        sgct::ScreenCapture::setOfflineExport(isSavingFrames);
+    }
+
 #ifdef OPENVR_SUPPORT
     if (FirstOpenVRWindow) {
         // Update pose matrices for all tracked OpenVR devices once per frame
@@ -710,6 +736,25 @@ std::vector<std::byte> mainEncode() {
     LTRACE("main::mainEncode(begin)");
 
     std::vector<std::byte> data = global::openSpaceEngine->encode();
+    if (compressedSync.value_or(false)) {
+        // All clients have received the previous frame unless the master stopped waiting
+        // for them, in which case the deltas stay relative to an older frame
+        if (sgct::NetworkManager::instance().isSyncComplete()) {
+            syncEncoder.acknowledge();
+        }
+        data = syncEncoder.encode(data);
+
+        const unsigned int frame = Engine::instance().currentFrameNumber();
+        if (frame % StatisticsHistory::HistoryLength == 0) {
+            const StatisticsHistory& dataSizes = syncEncoder.dataSizes();
+            const StatisticsHistory& messageSizes = syncEncoder.messageSizes();
+            LINFO(std::format(
+                "Synchronized {:.0f} bytes per frame as {:.0f} bytes (p95 {:.0f} bytes)",
+                dataSizes.average(), messageSizes.average(),
+                messageSizes.percentiles().p95
+            ));
+        }
+    }
 
     LTRACE("main::mainEncode(end)");
     return data;
@@ -721,7 +766,16 @@ void mainDecode(const std::vector<std::byte>& data) {
     ZoneScoped;
     LTRACE("main::mainDecode(begin)");
 
-    global::openSpaceEngine->decode(data);
+    if (compressedSync.value_or(false)) {
+        if (!syncDecoder.decode(data, syncData)) {
+            LDEBUG("Skipping synchronized data until the next keyframe");
+            return;
+        }
+        global::openSpaceEngine->decode(syncData);
+    }
+    else {
+        global::openSpaceEngine->decode(data);
+    }
 
     LTRACE("main::mainDecode(end)");
 }
@@ -748,6 +802,122 @@ void mainLogCallback(Log::Level level, std::string_view message) {
 }
 
 
+template <typename T>
+void readCaptureSetting(const ghoul::Dictionary& dict, std::string_view key, T& value) {
+    if (dict.hasValue<double>(key)) {
+        value = static_cast<T>(dict.value<double>(key));
+    }
+    else if (dict.hasValue<int>(key)) {
+        value = static_cast<T>(dict.value<int>(key));
+    }
+}
+
+void readCaptureSetting(const ghoul::Dictionary& dict, std::string_view key, bool& value)
+{
+    if (dict.hasValue<bool>(key)) {
+        value = dict.value<bool>(key);
+    }
+}
+
+void readCaptureSetting(const ghoul::Dictionary& dict, std::string_view key,
+                        std::string& value)
+{
+    if (dict.hasValue<std::string>(key)) {
+        value = dict.value<std::string>(key);
+    }
+}
+
+template <typename T>
+void readCaptureSetting(const ghoul::Dictionary& dict, std::string_view key, T& value,
+                        const std::map<std::string_view, T>& options)
+{
+    if (!dict.hasValue<std::string>(key)) {
+        return;
+    }
+    const std::string name = dict.value<std::string>(key);
+    const auto it = options.find(name);
+    if (it == options.end()) {
+        LWARNING(std::format("Unknown value '{}' for ScreenCapture.{}", name, key));
+        return;
+    }
+    value = it->second;
+}
+
+/**
+ * Applies the `ScreenCapture` table of the configuration file to the screen captures of
+ * SGCT, for example `ScreenCapture = { Format = "QOI", EncoderThreads = 4 }`. Settings
+ * that are not in the table keep their default value.
+ */
+void applyScreenCaptureSettings() {
+    lua_State* state = global::configuration->state;
+    lua_getglobal(state, "ScreenCapture");
+    if (!lua_istable(state, -1)) {
+        lua_pop(state, 1);
+        return;
+    }
+    const ghoul::Dictionary dict =
+        ghoul::lua::value<ghoul::Dictionary>(state, -1, ghoul::lua::PopValue::Yes);
+
+    using Policy = sgct::CapturePool::OverflowPolicy;
+    using Format = sgct::ScreenCapture::CaptureFormat;
+    using Layout = sgct::ScreenCapture::StereoLayout;
+    sgct::ScreenCapture::Settings s;
+    readCaptureSetting(dict, "QueueLength", s.queueLength);
+    readCaptureSetting(
+        dict,
+        "OverflowPolicy",
+        s.overflowPolicy,
+        {
+            { "Block", Policy::Block },
+            { "DropOldest", Policy::DropOldest },
+            { "DropNewest", Policy::DropNewest }
+        }
+    );
+    readCaptureSetting(dict, "ReadbackDepth", s.readbackDepth);
+    readCaptureSetting(dict, "PersistentMapping", s.usePersistentMapping);
+    readCaptureSetting(dict, "EncoderThreads", s.nEncoderThreads);
+    readCaptureSetting(dict, "CompressionLevel", s.pngCompressionLevel);
+    readCaptureSetting(
+        dict,
+        "PngFilter",
+        s.pngFilter,
+        {
+            { "None", sgct::Image::PngFilter::None },
+            { "Sub", sgct::Image::PngFilter::Sub },
+            { "Up", sgct::Image::PngFilter::Up }
+        }
+    );
+    readCaptureSetting(dict, "AdaptivePngBudget", s.adaptivePngBudget);
+    readCaptureSetting(dict, "ContainerPreallocation", s.containerPreallocation);
+    readCaptureSetting(
+        dict,
+        "Format",
+        s.format,
+        {
+            { "PNG", Format::PNG },
+            { "QOI", Format::QOI },
+            { "Y4M", Format::Y4M },
+            { "RawRGB", Format::RawRGB },
+            { "EXR", Format::EXR }
+        }
+    );
+    readCaptureSetting(dict, "Container", s.useContainer);
+    readCaptureSetting(dict, "VideoCommand", s.videoCommand);
+    readCaptureSetting(dict, "VideoFrameRate", s.videoFrameRate);
+    readCaptureSetting(dict, "BandHeight", s.bandHeight);
+    readCaptureSetting(dict, "CombineStereo", s.combineStereo);
+    readCaptureSetting(
+        dict,
+        "StereoLayout",
+        s.stereoLayout,
+        { { "SideBySide", Layout::SideBySide }, { "TopBottom", Layout::TopBottom } }
+    );
+    readCaptureSetting(dict, "CaptureWriter", s.useCaptureWriter);
+    readCaptureSetting(dict, "PreviewFactor", s.previewFactor);
+    readCaptureSetting(dict, "PreviewInterval", s.previewInterval);
+    sgct::ScreenCapture::setSettings(std::move(s));
+}
+
 void setSgctDelegateFunctions() {
     WindowDelegate& sgctDelegate = *global::windowDelegate;
     sgctDelegate.terminate = []() { Engine::instance().terminate(); };
@@ -796,6 +966,21 @@ void setSgctDelegateFunctions() {
 
         return Engine::instance().statistics().dt();
     };
+    sgctDelegate.captureQueueDepth = []() {
+        return Engine::instance().statistics().captureQueueDepth.newest();
+    };
+    sgctDelegate.captureReadbackWaitTime = []() {
+        return Engine::instance().statistics().captureReadbackWaitTimes.newest();
+    };
+    sgctDelegate.captureEncodeTime = []() {
+        return Engine::instance().statistics().captureEncodeTimes.newest();
+    };
+    sgctDelegate.captureWriteTime = []() {
+        return Engine::instance().statistics().captureWriteTimes.newest();
+    };
+    sgctDelegate.captureDroppedFrames = []() {
+        return Engine::instance().statistics().droppedCaptureFrames.newest();
+    };
     sgctDelegate.applicationTime = []() {
         ZoneScoped;
 
@@ -1289,6 +1474,14 @@ int main(int argc, char* argv[]) {
         "Specifies whether the Launcher should be shown at startup or not. This value "
         "overrides the value specified in the `openspace.cfg` and the settings."
     ));
+    parser.addCommand(std::make_unique<ghoul::cmdparser::SingleCommandZeroArguments>(
+        compressedSync,
+        "--compressedSync",
+        "",
+        "Sends the data that is synchronized between the nodes of a cluster every frame "
+        "as the compressed difference to the previous frame. All nodes of the cluster "
+        "have to be started with this argument."
+    ));
 
     parser.setCommandLine({ argv, argv + argc });
 
@@ -1641,6 +1834,9 @@ int main(int argc, char* argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    LDEBUG("Applying screen capture settings");
+    applyScreenCaptureSettings();
+
     LDEBUG("Setting callbacks");
     Engine::Callbacks callbacks = {
         .initOpenGL = mainInitFunc,
@@ -0,0 +1,98 @@
+#!/bin/bash
+# Copies the SGCT overlays of this directory into the SGCT tree that is passed as the
+# only argument and adds the sources that upstream SGCT does not have yet to its build:
+#   appdir/install-sgct-overlays.sh "$openSpaceHome/apps/OpenSpace/ext/sgct"
+# The overlays are named after their path in the SGCT tree, for example
+# sgct-include-sgct-image.h is include/sgct/image.h and sgct-src-image.cpp is
+# src/image.cpp. The tools in apps/capturetools are built with -DSGCT_CAPTURE_TOOLS=ON
+
+set -e
+
+sgct="$1"
+overlays="$(cd "$(dirname "$0")" && pwd)"
+if [ ! -f "$sgct/src/CMakeLists.txt" ]; then
+  echo "'$sgct' is not an SGCT source tree"
+  exit 1
+fi
+
+newSources=""
+for f in "$overlays"/sgct-include-sgct-*.h; do
+  name=$(basename "$f")
+  name=${name#sgct-include-sgct-}
+  if [ ! -f "$sgct/include/sgct/$name" ]; then
+    newSources="$newSources \${PROJECT_SOURCE_DIR}/include/sgct/$name"
+  fi
+  cp -v "$f" "$sgct/include/sgct/$name"
+done
+for f in "$overlays"/sgct-src-*.cpp; do
+  name=$(basename "$f")
+  name=${name#sgct-src-}
+  if [ ! -f "$sgct/src/$name" ]; then
+    newSources="$newSources $name"
+  fi
+  cp -v "$f" "$sgct/src/$name"
+done
+
+# The windows draw the capture statistics graph right after the statistics graphs in
+# their 2D pass, as upstream SGCT has no hook for it
+window="$sgct/src/window.cpp"
+if ! grep -q "captureStatisticsRenderer" "$window"; then
+  perl -pi -e 's|^(#include <sgct/engine.h>\n)|#include <sgct/capturestatisticsrenderer.h>\n$1|' "$window"
+  perl -0pi -e 's|^([ \t]*)(.*statisticsRenderer\(\)->render\(.*;\n)|$1$2$1if (auto* r = Engine::instance().captureStatisticsRenderer()) {\n$1    r->render();\n$1}\n|m' "$window"
+  if ! grep -q "sgct/capturestatisticsrenderer.h" "$window" ||
+     ! grep -q "captureStatisticsRenderer()" "$window"
+  then
+    echo "Patching $window failed"
+    exit 1
+  fi
+fi
+
+# The FrameLockBarrier waits on NetworkManager::cond while holding NetworkManager::mutex,
+# so the network threads have to notify while holding it as well. Otherwise a message
+# that arrives between the check of the barrier and its wait is missed
+header="$sgct/include/sgct/networkmanager.h"
+if ! grep -q "static std::mutex mutex;" "$header"; then
+  perl -pi -e 's|^#include <condition_variable>\n|#include <condition_variable>\n#include <mutex>\n| unless /mutex/' "$header"
+  perl -pi -e 's|^([ \t]*)(static std::condition_variable cond;\n)|$1$2$1static std::mutex mutex;\n|' "$header"
+  perl -pi -e 's|^(std::condition_variable NetworkManager::cond;\n)|$1std::mutex NetworkManager::mutex;\n|' "$sgct/src/networkmanager.cpp"
+  for f in "$sgct"/src/network*.cpp; do
+    perl -pi -e 's|^([ \t]*)((?:NetworkManager::)?cond\.notify_all\(\);\n)|$1\{\n$1    const std::lock_guard lock(NetworkManager::mutex);\n$1    $2$1\}\n|' "$f"
+  done
+  if ! grep -q "static std::mutex mutex;" "$header" ||
+     ! grep -q "std::mutex NetworkManager::mutex;" "$sgct/src/networkmanager.cpp" ||
+     ! grep -q "lock_guard lock(NetworkManager::mutex)" "$sgct"/src/network*.cpp ||
+     ! perl -ne 'exit 1 if /cond\.notify_all/ && $p !~ /lock_guard/; $p = $_' \
+       "$sgct"/src/network*.cpp
+  then
+    echo "Patching the network notifications in $sgct failed"
+    exit 1
+  fi
+fi
+
+mkdir -p "$sgct/apps/capturetools"
+for f in "$overlays"/sgct-apps-capturetools-*; do
+  name=$(basename "$f")
+  name=${name#sgct-apps-capturetools-}
+  cp -v "$f" "$sgct/apps/capturetools/$name"
+done
+
+if [ -n "$newSources" ]; then
+  cat >> "$sgct/src/CMakeLists.txt" << EOF
+
+# Files of the appdir overlays that upstream SGCT does not have
+target_sources(sgct PRIVATE$newSources)
+EOF
+fi
+
+if ! grep -q "SGCT_CAPTURE_TOOLS" "$sgct/src/CMakeLists.txt"; then
+  cat >> "$sgct/src/CMakeLists.txt" << 'EOF'
+
+option(SGCT_CAPTURE_TOOLS "Build the tools for converting captured frames" OFF)
+if (SGCT_CAPTURE_TOOLS)
+  add_subdirectory(
+    ${PROJECT_SOURCE_DIR}/apps/capturetools
+    ${CMAKE_CURRENT_BINARY_DIR}/capturetools
+  )
+endif ()
+EOF
+fi
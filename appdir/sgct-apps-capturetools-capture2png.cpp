@@ -0,0 +1,83 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/capturecontainer.h>
+#include <sgct/format.h>
+#include <sgct/image.h>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+// Converts frames that were captured in one of the intermediate formats into PNG files
+// that are placed next to the original files. Capture containers are extracted into one
+// PNG file per frame, or one EXR file for floating-point frames
+
+namespace {
+    void extractContainer(const std::filesystem::path& input) {
+        const sgct::CaptureContainerReader reader(input);
+
+        const std::filesystem::path base = input.parent_path() / input.stem();
+        for (const sgct::capturecontainer::Entry& entry : reader.entries()) {
+            // Same order as the file names of individually captured frames
+            std::string eye;
+            if (entry.eye == 1) {
+                eye = "L_";
+            }
+            else if (entry.eye == 2) {
+                eye = "R_";
+            }
+            else if (entry.eye == 3) {
+                eye = "LR_";
+            }
+            const bool isFloat = entry.codec == sgct::capturecontainer::Codec::RawFloat;
+            std::filesystem::path output = base;
+            output += std::format(
+                "_win{}_{}{:06}.{}",
+                entry.windowId, eye, entry.frameNumber, isFloat ? "exr" : "png"
+            );
+
+            sgct::Image image;
+            reader.read(entry, image);
+            image.save(output);
+            std::cout << input.string() << " -> " << output.string() << '\n';
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cout << "Usage: capture2png <file> [<file> ...]\n";
+        return EXIT_FAILURE;
+    }
+
+    int nErrors = 0;
+    for (int i = 1; i < argc; i++) {
+        const std::filesystem::path input = argv[i];
+
+        try {
+            if (input.extension() == ".sgctcap") {
+                extractContainer(input);
+                continue;
+            }
+
+            std::filesystem::path output = input;
+            output.replace_extension(".png");
+
+            sgct::Image image;
+            image.load(input);
+            image.save(output);
+            std::cout << input.string() << " -> " << output.string() << '\n';
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << input.string() << ": " << e.what() << '\n';
+            nErrors++;
+        }
+    }
+    return nErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,427 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/capturepool.h>
+#include <sgct/capturewriter.h>
+#include <sgct/format.h>
+#include <sgct/image.h>
+#include <sgct/pixelconversion.h>
+#include <sgct/videostream.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures how fast captured frames are encoded and written without a GPU or a window.
+// Synthetic frames are handed to a CapturePool in the same way as the ScreenCapture does
+// after a readback, for every combination of frame size, format, compression level, and
+// number of capture threads. EXR uses half-float frames like an HDR window.
+//
+// Usage: capturebench [options]
+//   --sizes <list>     1080p, 4k, 8k, fisheye, or <w>x<h>   (default: 1080p,4k)
+//   --formats <list>   png, qoi, y4m, raw, exr              (default: png,qoi)
+//   --levels <list>    PNG and EXR compression levels 0-9   (default: 1)
+//   --threads <list>   Number of capture threads            (default: 1,2,4,<cores>)
+//   --frames <n>       Frames per configuration             (default: 30)
+//   --channels <n>     3 or 4                               (default: 3)
+//   --output <dir>     Where the frames are written         (default: temp directory)
+//   --writer <mode>    none, thread, uring, or direct       (default: none)
+//                      Files other than video streams are written by a CaptureWriter
+//                      with a writer thread, an io_uring, or an io_uring with O_DIRECT
+//   --csv              Print the results as CSV
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Resolution {
+        std::string name;
+        sgct::ivec2 size;
+    };
+
+    struct Options {
+        std::vector<Resolution> sizes = {
+            { "1080p", sgct::ivec2{ 1920, 1080 } },
+            { "4k", sgct::ivec2{ 3840, 2160 } }
+        };
+        std::vector<std::string> formats = { "png", "qoi" };
+        std::vector<int> levels = { 1 };
+        std::vector<int> threads;
+        int nFrames = 30;
+        int nChannels = 3;
+        std::filesystem::path output;
+        std::string writer = "none";
+        bool csv = false;
+    };
+
+    struct Result {
+        double msPerFrame = 0.0;
+        double framesPerSecond = 0.0;
+        double bytesPerFrame = 0.0;
+    };
+
+    std::vector<std::string> split(const std::string& list) {
+        std::vector<std::string> res;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) {
+                res.push_back(item);
+            }
+        }
+        return res;
+    }
+
+    Resolution parseResolution(const std::string& name) {
+        if (name == "1080p") {
+            return { name, sgct::ivec2{ 1920, 1080 } };
+        }
+        if (name == "4k") {
+            return { name, sgct::ivec2{ 3840, 2160 } };
+        }
+        if (name == "8k") {
+            return { name, sgct::ivec2{ 7680, 4320 } };
+        }
+        if (name == "fisheye") {
+            // A typical dome master
+            return { name, sgct::ivec2{ 4096, 4096 } };
+        }
+        const size_t x = name.find('x');
+        if (x == std::string::npos) {
+            throw std::runtime_error("Unknown size '" + name + "'");
+        }
+        const int width = std::stoi(name.substr(0, x));
+        const int height = std::stoi(name.substr(x + 1));
+        if (width <= 0 || height <= 0) {
+            throw std::runtime_error("Invalid size '" + name + "'");
+        }
+        return { name, sgct::ivec2{ width, height } };
+    }
+
+    // Returns the half-float bit pattern of v / 255
+    uint16_t toHalf(int v) {
+        if (v == 0) {
+            return 0;
+        }
+        const float f = static_cast<float>(v) / 255.f;
+        uint32_t bits = 0;
+        std::memcpy(&bits, &f, sizeof(float));
+        const uint32_t exponent = ((bits >> 23) & 0xFF) - 127 + 15;
+        return static_cast<uint16_t>((exponent << 10) | ((bits >> 13) & 0x3FF));
+    }
+
+    // Creates frames that compress roughly like rendered content: smooth gradients with
+    // some noise and a pattern that moves from frame to frame. Half-float frames contain
+    // the same values in the range [0, 1]
+    std::vector<std::unique_ptr<sgct::Image>> createFrames(sgct::ivec2 size,
+                                                           int nChannels, int nFrames,
+                                                           bool isHalf)
+    {
+        std::mt19937 rng(42);
+        std::vector<std::unique_ptr<sgct::Image>> frames;
+        for (int f = 0; f < nFrames; f++) {
+            auto image = std::make_unique<sgct::Image>();
+            image->setSize(size);
+            image->setChannels(nChannels);
+            image->setBytesPerChannel(isHalf ? 2 : 1);
+            image->setFloatingPoint(isHalf);
+            image->allocateOrResizeData();
+
+            unsigned char* data = image->data();
+            uint16_t* halfData = reinterpret_cast<uint16_t*>(image->data());
+            std::array<int, 4> pixel = { 0, 0, 0, 255 };
+            for (int y = 0; y < size.y; y++) {
+                for (int x = 0; x < size.x; x++) {
+                    const int noise = static_cast<int>(rng() % 8);
+                    const bool isStripe = ((x + y + f * 16) / 64) % 2 == 0;
+                    pixel[0] = x * 255 / size.x;
+                    pixel[1] = y * 255 / size.y;
+                    pixel[2] = (isStripe ? 200 : 50) + noise;
+                    for (int c = 0; c < nChannels; c++) {
+                        if (isHalf) {
+                            *halfData++ = toHalf(pixel[c]);
+                        }
+                        else {
+                            *data++ = static_cast<unsigned char>(pixel[c]);
+                        }
+                    }
+                }
+            }
+            frames.push_back(std::move(image));
+        }
+        return frames;
+    }
+
+    Result run(const std::vector<std::unique_ptr<sgct::Image>>& frames,
+               const std::string& format, int level, int nThreads, int nFrames,
+               const std::filesystem::path& directory, const std::string& writerMode)
+    {
+        // The same queue length as the default capture settings
+        constexpr size_t QueueLength = 4;
+        const sgct::ivec2 size = frames.front()->size();
+
+        std::shared_ptr<sgct::VideoStream> stream;
+        if (format == "y4m" || format == "raw") {
+            stream = std::make_shared<sgct::VideoStream>(
+                (directory / ("capture." + format)).string(),
+                format == "y4m" ? sgct::VideoStream::Format::Y4M :
+                    sgct::VideoStream::Format::RawRGB,
+                size,
+                60
+            );
+        }
+
+        std::atomic<int64_t> encodeNanoseconds = 0;
+        std::atomic<uint64_t> nBytes = 0;
+        std::atomic<int> nFailed = 0;
+        const Clock::time_point t0 = Clock::now();
+        {
+            std::shared_ptr<sgct::CaptureWriter> writer;
+            if (!stream && writerMode != "none") {
+                sgct::CaptureWriter::Settings settings;
+                settings.useIoUring = writerMode != "thread";
+                settings.useDirectIO = writerMode == "direct";
+                writer = std::make_shared<sgct::CaptureWriter>(settings);
+            }
+
+            sgct::CapturePool pool(
+                nThreads,
+                QueueLength,
+                sgct::CapturePool::OverflowPolicy::Block
+            );
+            for (int i = 0; i < nFrames; i++) {
+                // Enough frames are generated so that a frame is never used by two jobs
+                // at the same time
+                sgct::Image* image = frames[i % frames.size()].get();
+                image->setPngCompressionLevel(level);
+
+                sgct::CapturePool::Job job;
+                if (stream) {
+                    job = [image, stream, position = stream->reserveFrame(), &nBytes]() {
+                        std::vector<unsigned char> frame = stream->encode(*image);
+                        nBytes += frame.size();
+                        stream->submit(*position, std::move(frame));
+                    };
+                }
+                else if (writer) {
+                    const std::filesystem::path file =
+                        directory / std::format("capture_{:06}.{}", i, format);
+                    job = [image, file, writer, &nBytes]() {
+                        std::vector<unsigned char> buffer = image->encode(file);
+                        nBytes += buffer.size();
+                        writer->write(file, std::move(buffer));
+                    };
+                }
+                else {
+                    const std::filesystem::path file =
+                        directory / std::format("capture_{:06}.{}", i, format);
+                    job = [image, file, &nBytes]() {
+                        image->save(file);
+                        nBytes += std::filesystem::file_size(file);
+                    };
+                }
+
+                pool.enqueue([job = std::move(job), &encodeNanoseconds, &nFailed]() {
+                    const Clock::time_point start = Clock::now();
+                    try {
+                        job();
+                    }
+                    catch (const std::exception& e) {
+                        std::cerr << e.what() << '\n';
+                        nFailed++;
+                    }
+                    encodeNanoseconds += (Clock::now() - start).count();
+                });
+            }
+            // Destroying the pool waits for all frames to be encoded and destroying the
+            // writer afterwards for all files to be written
+        }
+        stream = nullptr;
+        if (nFailed > 0) {
+            throw std::runtime_error(std::format("{} frames failed", nFailed.load()));
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        Result res;
+        res.msPerFrame = encodeNanoseconds / 1e6 / nFrames;
+        res.framesPerSecond = nFrames / seconds;
+        res.bytesPerFrame = static_cast<double>(nBytes) / nFrames;
+        return res;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--sizes" && hasValue) {
+                options.sizes.clear();
+                for (const std::string& s : split(argv[++i])) {
+                    options.sizes.push_back(parseResolution(s));
+                }
+            }
+            else if (arg == "--formats" && hasValue) {
+                options.formats = split(argv[++i]);
+                for (const std::string& f : options.formats) {
+                    if (f != "png" && f != "qoi" && f != "y4m" && f != "raw" &&
+                        f != "exr")
+                    {
+                        throw std::runtime_error("Unknown format '" + f + "'");
+                    }
+                }
+            }
+            else if (arg == "--levels" && hasValue) {
+                options.levels.clear();
+                for (const std::string& s : split(argv[++i])) {
+                    options.levels.push_back(std::stoi(s));
+                }
+            }
+            else if (arg == "--threads" && hasValue) {
+                for (const std::string& s : split(argv[++i])) {
+                    options.threads.push_back(std::max(std::stoi(s), 1));
+                }
+            }
+            else if (arg == "--frames" && hasValue) {
+                options.nFrames = std::max(std::stoi(argv[++i]), 1);
+            }
+            else if (arg == "--channels" && hasValue) {
+                options.nChannels = std::stoi(argv[++i]) == 4 ? 4 : 3;
+            }
+            else if (arg == "--output" && hasValue) {
+                options.output = argv[++i];
+            }
+            else if (arg == "--writer" && hasValue) {
+                options.writer = argv[++i];
+                if (options.writer != "none" && options.writer != "thread" &&
+                    options.writer != "uring" && options.writer != "direct")
+                {
+                    throw std::runtime_error("Unknown writer '" + options.writer + "'");
+                }
+            }
+            else if (arg == "--csv") {
+                options.csv = true;
+            }
+            else {
+                std::cout << "Unknown argument '" << arg << "'. See the top of "
+                    "capturebench.cpp for the list of options\n";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (options.threads.empty()) {
+        const int nCores = static_cast<int>(std::thread::hardware_concurrency());
+        for (int n : { 1, 2, 4 }) {
+            if (n < nCores) {
+                options.threads.push_back(n);
+            }
+        }
+        options.threads.push_back(std::max(nCores, 1));
+    }
+    const int maxThreads =
+        *std::max_element(options.threads.begin(), options.threads.end());
+
+    const bool isTemporary = options.output.empty();
+    if (isTemporary) {
+        options.output = std::filesystem::temp_directory_path() / "sgct-capturebench";
+    }
+    std::filesystem::create_directories(options.output);
+
+    if (options.csv) {
+        std::cout <<
+            "size,width,height,format,level,threads,ms_per_frame,fps,mb_per_frame\n";
+    }
+    else {
+        std::cout << "Writing to " << options.output.string()
+            << ", pixel conversion uses " << sgct::pixelconversion::instructionSet()
+            << '\n';
+        std::cout << std::left << std::setw(10) << "size" << std::setw(8) << "format"
+            << std::setw(7) << "level" << std::setw(9) << "threads" << std::right
+            << std::setw(12) << "ms/frame" << std::setw(10) << "fps"
+            << std::setw(12) << "MB/frame" << '\n';
+    }
+
+    int nErrors = 0;
+    for (const Resolution& resolution : options.sizes) {
+        // Each job in the queue and each thread holds a frame, plus the one being queued
+        const int nImages = std::min(options.nFrames, 4 + maxThreads + 1);
+        std::vector<std::unique_ptr<sgct::Image>> frames;
+        std::vector<std::unique_ptr<sgct::Image>> halfFrames;
+
+        for (const std::string& format : options.formats) {
+            const bool isHalf = format == "exr";
+            std::vector<std::unique_ptr<sgct::Image>>& source =
+                isHalf ? halfFrames : frames;
+            if (source.empty()) {
+                source =
+                    createFrames(resolution.size, options.nChannels, nImages, isHalf);
+            }
+
+            // The compression level only applies to PNG and EXR
+            const bool hasLevels = format == "png" || format == "exr";
+            const std::vector<int> levels =
+                hasLevels ? options.levels : std::vector<int>{ 0 };
+            for (int level : levels) {
+                for (int nThreads : options.threads) {
+                    Result res;
+                    try {
+                        res = run(
+                            source, format, level, nThreads, options.nFrames,
+                            options.output, options.writer
+                        );
+                    }
+                    catch (const std::exception& e) {
+                        std::cerr << resolution.name << " " << format << ": " << e.what()
+                            << '\n';
+                        nErrors++;
+                        continue;
+                    }
+
+                    const double mb = res.bytesPerFrame / (1024.0 * 1024.0);
+                    if (options.csv) {
+                        std::cout << resolution.name << ',' << resolution.size.x << ','
+                            << resolution.size.y << ',' << format << ',' << level << ','
+                            << nThreads << ',' << res.msPerFrame << ','
+                            << res.framesPerSecond << ',' << mb << '\n';
+                    }
+                    else {
+                        std::cout << std::fixed << std::setprecision(2) << std::left
+                            << std::setw(10) << resolution.name << std::setw(8) << format
+                            << std::setw(7) << level << std::setw(9) << nThreads
+                            << std::right << std::setw(12) << res.msPerFrame
+                            << std::setw(10) << res.framesPerSecond << std::setw(12) << mb
+                            << '\n';
+                    }
+                }
+            }
+        }
+    }
+
+    if (isTemporary) {
+        std::filesystem::remove_all(options.output);
+    }
+    return nErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,299 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/commandline.h>
+#include <sgct/engine.h>
+#include <sgct/format.h>
+#include <sgct/framelockbarrier.h>
+#include <sgct/log.h>
+#include <sgct/networkmanager.h>
+#include <sgct/statisticshistory.h>
+#include <sgct/syncdelta.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+// Measures the frame lock of a cluster on a single machine. One master and a number of
+// clients run as separate processes that are connected through the loopback interface,
+// and the master synchronizes a synthetic payload to the clients every frame. Nothing is
+// drawn into the windows, so no GPU is needed when running under a virtual X server with
+// a software OpenGL implementation:
+//
+//   xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 clusterbench --clients 4
+//
+// At the end, every node prints the distribution of its sync times and of the time that
+// it waited in the frame lock barrier for each of the other nodes, over the last frames.
+//
+// Usage: clusterbench [options]
+//   --clients <n>      Number of client processes                   (default: 2)
+//   --payload <bytes>  Size of the data that is synchronized        (default: 4096)
+//   --changed <bytes>  Bytes of the data that change every frame    (default: 64)
+//   --frames <n>       Frames to run                                (default: 600)
+//   --port <n>         Port of the master, the clients use the next (default: 20401)
+//   --compressed       Synchronize the data through a SyncDeltaEncoder
+//   --node <index>     Runs a single node of the cluster, used by the processes that
+//                      are started by the benchmark
+
+namespace {
+    struct Options {
+        int nClients = 2;
+        int payloadSize = 4096;
+        int nChanged = 64;
+        int nFrames = 600;
+        int port = 20401;
+        bool isCompressed = false;
+        int node = -1;
+    };
+
+    std::vector<std::string> nodeArguments(const Options& options, int node) {
+        std::vector<std::string> res = {
+            "--clients", std::to_string(options.nClients),
+            "--payload", std::to_string(options.payloadSize),
+            "--changed", std::to_string(options.nChanged),
+            "--frames", std::to_string(options.nFrames),
+            "--port", std::to_string(options.port),
+            "--node", std::to_string(node)
+        };
+        if (options.isCompressed) {
+            res.push_back("--compressed");
+        }
+        return res;
+    }
+
+    sgct::config::Cluster createCluster(const Options& options) {
+        sgct::config::Cluster cluster = sgct::defaultCluster();
+        cluster.masterAddress = "127.0.0.1";
+
+        const sgct::config::Node node = cluster.nodes.front();
+        cluster.nodes.clear();
+        for (int i = 0; i <= options.nClients; i++) {
+            sgct::config::Node n = node;
+            n.address = "127.0.0.1";
+            n.port = options.port + i;
+            for (sgct::config::Window& window : n.windows) {
+                window.size = sgct::ivec2{ 64, 64 };
+            }
+            cluster.nodes.push_back(std::move(n));
+        }
+        return cluster;
+    }
+
+    // Returns the 50th, 95th, and 99th percentile and the maximum of the \p history
+    std::string describe(const sgct::StatisticsHistory& history) {
+        const sgct::StatisticsHistory::Percentiles p = history.percentiles();
+        return std::format(
+            "p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+            p.p50 * 1000.0, p.p95 * 1000.0, p.p99 * 1000.0, history.max() * 1000.0
+        );
+    }
+
+    void report(const Options& options, uint64_t nDecoded, uint64_t nSkipped) {
+        const sgct::StatisticsHistory& syncTimes =
+            sgct::Engine::instance().statistics().syncTimes;
+        const std::string name =
+            options.node == 0 ? "master" : std::format("client {}", options.node);
+        std::string res = std::format(
+            "{}: {} sync times, {}\n", name, syncTimes.size(), describe(syncTimes)
+        );
+
+        const sgct::FrameLockBarrier::Statistics& barrier =
+            sgct::FrameLockBarrier::statistics();
+        for (size_t i = 0; i < barrier.nodeLatencies.size(); i++) {
+            const std::string other =
+                options.node == 0 ? std::format("client {}", i + 1) : "master";
+            res += std::format(
+                "  waited for {}: {}\n", other, describe(barrier.nodeLatencies[i])
+            );
+        }
+
+        if (options.node > 0) {
+            res += std::format(
+                "  decoded {} frames, skipped {} frames\n", nDecoded, nSkipped
+            );
+        }
+        std::cout << res;
+    }
+
+    int runNode(const Options& options) {
+        std::mt19937 rng(1234);
+        std::vector<std::byte> payload(options.payloadSize);
+        std::generate(
+            payload.begin(),
+            payload.end(),
+            [&rng]() { return static_cast<std::byte>(rng()); }
+        );
+        sgct::SyncDeltaEncoder encoder;
+        sgct::SyncDeltaDecoder decoder;
+        std::vector<std::byte> decoded;
+        uint64_t nDecoded = 0;
+        uint64_t nSkipped = 0;
+
+        sgct::Engine::Callbacks callbacks;
+        callbacks.preSync = [&]() {
+            if (options.node != 0 || payload.empty()) {
+                return;
+            }
+            for (int i = 0; i < options.nChanged; i++) {
+                payload[rng() % payload.size()] = static_cast<std::byte>(rng());
+            }
+        };
+        callbacks.encode = [&]() {
+            if (!options.isCompressed) {
+                return payload;
+            }
+            if (sgct::NetworkManager::instance().isSyncComplete()) {
+                encoder.acknowledge();
+            }
+            return encoder.encode(payload);
+        };
+        callbacks.decode = [&](const std::vector<std::byte>& data) {
+            if (!options.isCompressed) {
+                nDecoded += data.size() == payload.size() ? 1 : 0;
+            }
+            else if (decoder.decode(data, decoded)) {
+                nDecoded++;
+            }
+            else {
+                nSkipped++;
+            }
+        };
+        callbacks.draw = [](const sgct::RenderData&) {};
+        callbacks.postDraw = [&options]() {
+            // The clients stop when the master has disconnected
+            sgct::Engine& engine = sgct::Engine::instance();
+            const int frame = static_cast<int>(engine.currentFrameNumber());
+            if (options.node == 0 && frame + 1 >= options.nFrames) {
+                engine.terminate();
+            }
+        };
+
+        sgct::Configuration config;
+        config.isServer = options.node == 0;
+        config.nodeId = options.node;
+        config.logLevel = sgct::Log::Level::Warning;
+        try {
+            sgct::Engine::create(createCluster(options), std::move(callbacks), config);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << '\n';
+            sgct::Engine::destroy();
+            return EXIT_FAILURE;
+        }
+        sgct::Engine::instance().exec();
+        report(options, nDecoded, nSkipped);
+        sgct::Engine::destroy();
+        return EXIT_SUCCESS;
+    }
+
+    int runCluster(const Options& options) {
+        const std::filesystem::path executable =
+            std::filesystem::read_symlink("/proc/self/exe");
+
+        std::cout << std::format(
+            "Starting a master and {} clients that synchronize {} bytes per frame{}\n",
+            options.nClients, options.payloadSize,
+            options.isCompressed ? " as compressed deltas" : ""
+        ) << std::flush;
+        std::vector<pid_t> processes;
+        for (int i = 0; i <= options.nClients; i++) {
+            std::vector<std::string> arguments = nodeArguments(options, i);
+            arguments.insert(arguments.begin(), executable.string());
+            std::vector<char*> argv;
+            for (std::string& argument : arguments) {
+                argv.push_back(argument.data());
+            }
+            argv.push_back(nullptr);
+
+            pid_t pid = 0;
+            const int res = posix_spawn(
+                &pid,
+                executable.c_str(),
+                nullptr,
+                nullptr,
+                argv.data(),
+                environ
+            );
+            if (res != 0) {
+                std::cerr << "Could not start node " << i << ": " << std::strerror(res)
+                    << '\n';
+                break;
+            }
+            processes.push_back(pid);
+        }
+
+        int nFailed = options.nClients + 1 - static_cast<int>(processes.size());
+        for (const pid_t pid : processes) {
+            int status = 0;
+            if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+                WEXITSTATUS(status) != EXIT_SUCCESS)
+            {
+                nFailed++;
+            }
+        }
+        if (nFailed > 0) {
+            std::cerr << nFailed << " of the nodes failed\n";
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--clients" && hasValue) {
+                options.nClients = std::max(std::stoi(argv[++i]), 1);
+            }
+            else if (arg == "--payload" && hasValue) {
+                options.payloadSize = std::max(std::stoi(argv[++i]), 0);
+            }
+            else if (arg == "--changed" && hasValue) {
+                options.nChanged = std::max(std::stoi(argv[++i]), 0);
+            }
+            else if (arg == "--frames" && hasValue) {
+                options.nFrames = std::max(std::stoi(argv[++i]), 1);
+            }
+            else if (arg == "--port" && hasValue) {
+                options.port = std::stoi(argv[++i]);
+            }
+            else if (arg == "--compressed") {
+                options.isCompressed = true;
+            }
+            else if (arg == "--node" && hasValue) {
+                options.node = std::stoi(argv[++i]);
+            }
+            else {
+                std::cout << "Unknown argument '" << arg << "'. See the top of "
+                    "clusterbench.cpp for the list of options\n";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cout << "Invalid argument: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return options.node >= 0 ? runNode(options) : runCluster(options);
+}
@@ -0,0 +1,210 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/pixelconversion.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Compares the pixel conversion kernels against the scalar loops that were previously
+// used by sgct::Image to load images and to prepare rows for PNG compression.
+//
+// Usage: pixelbench [<width> <height> [<iterations>]]
+
+namespace {
+    // The loop from Image::load
+    void referenceSwapRedBlue(unsigned char* data, size_t nPixels, int nChannels) {
+        const size_t size = nPixels * nChannels;
+        for (size_t i = 0; i < size; i += nChannels) {
+            std::swap(data[i], data[i + 2]);
+        }
+    }
+
+    // The loop from the PNG row preparation in the capture path
+    void referenceConvertRow(const unsigned char* src, unsigned char* dst, size_t nPixels,
+                             int nChannels, int bytesPerChannel)
+    {
+        const size_t rowSize = nPixels * nChannels * bytesPerChannel;
+        std::memcpy(dst, src, rowSize);
+        if (bytesPerChannel == 2) {
+            for (size_t i = 0; i < rowSize; i += 2) {
+                std::swap(dst[i], dst[i + 1]);
+            }
+        }
+        const size_t pixelSize = static_cast<size_t>(nChannels) * bytesPerChannel;
+        const size_t offset = 2 * static_cast<size_t>(bytesPerChannel);
+        for (size_t i = 0; i < rowSize; i += pixelSize) {
+            std::swap_ranges(dst + i, dst + i + bytesPerChannel, dst + i + offset);
+        }
+    }
+
+    // Flipping the rows through a vector of row pointers like stb_image and libpng do
+    void referenceFlip(unsigned char* data, size_t rowSize, size_t nRows) {
+        std::vector<unsigned char> row(rowSize);
+        for (size_t y = 0; y < nRows / 2; y++) {
+            unsigned char* a = data + y * rowSize;
+            unsigned char* b = data + (nRows - 1 - y) * rowSize;
+            std::memcpy(row.data(), a, rowSize);
+            std::memcpy(a, b, rowSize);
+            std::memcpy(b, row.data(), rowSize);
+        }
+    }
+
+    // A straightforward box filter for the preview captures
+    void referenceDownscale(const unsigned char* src, int width, int height,
+                            int nChannels, int factor, unsigned char* dst)
+    {
+        const int outWidth = width / factor;
+        const int n = factor * factor;
+        for (int y = 0; y < height / factor; y++) {
+            for (int x = 0; x < outWidth; x++) {
+                for (int c = 0; c < nChannels; c++) {
+                    int sum = 0;
+                    for (int dy = 0; dy < factor; dy++) {
+                        for (int dx = 0; dx < factor; dx++) {
+                            const size_t i =
+                                (static_cast<size_t>(y * factor + dy) * width +
+                                    x * factor + dx) * nChannels + c;
+                            sum += src[i];
+                        }
+                    }
+                    const size_t o = (static_cast<size_t>(y) * outWidth + x) * nChannels;
+                    dst[o + c] = static_cast<unsigned char>((sum + n / 2) / n);
+                }
+            }
+        }
+    }
+
+    double measure(int nIterations, const std::function<void()>& func) {
+        // The first run is not counted to warm up the caches and page tables
+        func();
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < nIterations; i++) {
+            const auto t0 = std::chrono::steady_clock::now();
+            func();
+            const auto t1 = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+        }
+        return best;
+    }
+
+    void report(const std::string& name, size_t nBytes, double reference, double kernel,
+                bool isCorrect)
+    {
+        auto gbps = [nBytes](double s) { return nBytes / s / 1e9; };
+        std::cout << name << ": reference " << reference * 1000.0 << " ms ("
+            << gbps(reference) << " GB/s), kernel " << kernel * 1000.0 << " ms ("
+            << gbps(kernel) << " GB/s), speedup " << reference / kernel << 'x'
+            << (isCorrect ? "" : "  MISMATCH") << '\n';
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const int width = argc > 2 ? std::atoi(argv[1]) : 3840;
+    const int height = argc > 2 ? std::atoi(argv[2]) : 2160;
+    const int nIterations = argc > 3 ? std::atoi(argv[3]) : 10;
+    if (width <= 0 || height <= 0 || nIterations <= 0) {
+        std::cout << "Usage: pixelbench [<width> <height> [<iterations>]]\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Pixel conversion using " << sgct::pixelconversion::instructionSet()
+        << " for " << width << "x" << height << " pixels, best of " << nIterations
+        << " runs\n";
+
+    const size_t nPixels = static_cast<size_t>(width) * height;
+    std::mt19937 rng(1);
+    std::vector<unsigned char> input(nPixels * 8);
+    std::generate(input.begin(), input.end(), [&rng]() { return rng() & 0xFF; });
+
+    int nErrors = 0;
+    for (int bpc : { 1, 2 }) {
+        for (int nChannels : { 3, 4 }) {
+            const size_t rowSize = static_cast<size_t>(width) * nChannels * bpc;
+            const size_t size = rowSize * height;
+            const std::string name =
+                std::to_string(nChannels) + "x" + std::to_string(bpc * 8) + " bit";
+
+            // Row conversion for PNG compression
+            std::vector<unsigned char> a(size);
+            std::vector<unsigned char> b(size);
+            const double refConvert = measure(nIterations, [&]() {
+                for (int y = 0; y < height; y++) {
+                    referenceConvertRow(
+                        input.data() + y * rowSize, a.data() + y * rowSize,
+                        width, nChannels, bpc
+                    );
+                }
+            });
+            const double kernelConvert = measure(nIterations, [&]() {
+                for (int y = 0; y < height; y++) {
+                    sgct::pixelconversion::convertToPngLayout(
+                        input.data() + y * rowSize, b.data() + y * rowSize,
+                        width, nChannels, bpc
+                    );
+                }
+            });
+            const bool convertCorrect = a == b;
+            report("PNG rows  " + name, size, refConvert, kernelConvert, convertCorrect);
+            nErrors += convertCorrect ? 0 : 1;
+
+            if (bpc != 1) {
+                continue;
+            }
+
+            // Flip and swizzle after loading an image
+            std::memcpy(a.data(), input.data(), size);
+            std::memcpy(b.data(), input.data(), size);
+            const double refLoad = measure(nIterations, [&]() {
+                referenceFlip(a.data(), rowSize, height);
+                referenceSwapRedBlue(a.data(), nPixels, nChannels);
+            });
+            const double kernelLoad = measure(nIterations, [&]() {
+                sgct::pixelconversion::flipAndSwapRedBlue(
+                    b.data(), sgct::ivec2{ width, height }, nChannels
+                );
+            });
+            // Both sides ran the same number of times
+            const bool loadCorrect = a == b;
+            report("Load      " + name, size, refLoad, kernelLoad, loadCorrect);
+            nErrors += loadCorrect ? 0 : 1;
+
+            // Box filter for preview captures, the bytes are those of the input frame
+            for (int factor : { 2, 4, 8 }) {
+                std::fill(a.begin(), a.end(), 0);
+                std::fill(b.begin(), b.end(), 0);
+                const double refDown = measure(nIterations, [&]() {
+                    referenceDownscale(
+                        input.data(), width, height, nChannels, factor, a.data()
+                    );
+                });
+                const double kernelDown = measure(nIterations, [&]() {
+                    sgct::pixelconversion::downscale(
+                        input.data(), sgct::ivec2{ width, height }, nChannels, factor,
+                        b.data()
+                    );
+                });
+                const bool downCorrect = a == b;
+                report(
+                    "Preview/" + std::to_string(factor) + " " + name, size, refDown,
+                    kernelDown, downCorrect
+                );
+                nErrors += downCorrect ? 0 : 1;
+            }
+        }
+    }
+    return nErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,254 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/capturepool.h>
+#include <sgct/format.h>
+#include <sgct/image.h>
+#include <png.h>
+#include <algorithm>
+#include <csetjmp>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Checks that the PNG files that are compressed in strips on the workers of a CapturePool
+// decode to exactly the pixels of the image. Every combination of 8 and 16 bit, 1, 3, and
+// 4 channels, and PNG filter is encoded with the parallel path and with the single
+// threaded path through libpng, decoded with libpng, and compared byte by byte with the
+// pixels that the image should contain in the PNG layout (top-down, RGB(A), big-endian).
+//
+// Usage: pngroundtrip [options]
+//   --width <n>     Width of the images                              (default: 333)
+//   --height <n>    Height of the images                             (default: 517)
+//   --strips <n>    Number of strips of the parallel path            (default: 4)
+//   --level <n>     Compression level 0-9                            (default: 1)
+
+namespace {
+    struct Options {
+        int width = 333;
+        int height = 517;
+        int nStrips = 4;
+        int level = 1;
+    };
+
+    struct Reader {
+        const std::vector<unsigned char>& data;
+        size_t offset = 0;
+    };
+
+    void readData(png_structp png, png_bytep dst, png_size_t length) {
+        Reader* reader = reinterpret_cast<Reader*>(png_get_io_ptr(png));
+        if (reader->offset + length > reader->data.size()) {
+            png_error(png, "Read past the end of the PNG data");
+        }
+        std::memcpy(dst, reader->data.data() + reader->offset, length);
+        reader->offset += length;
+    }
+
+    // Decodes the \p file with libpng into rows without any transformation
+    std::vector<unsigned char> decodePng(const std::vector<unsigned char>& file,
+                                         int width, int height, int nChannels,
+                                         int bytesPerChannel)
+    {
+        png_structp png = png_create_read_struct(
+            PNG_LIBPNG_VER_STRING,
+            nullptr,
+            nullptr,
+            nullptr
+        );
+        png_infop info = png_create_info_struct(png);
+        std::vector<unsigned char> res;
+        std::vector<png_bytep> rows;
+        Reader reader = { file };
+        if (setjmp(png_jmpbuf(png))) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            throw std::runtime_error("libpng could not decode the file");
+        }
+        png_set_read_fn(png, &reader, readData);
+        png_read_info(png, info);
+
+        const int fileWidth = static_cast<int>(png_get_image_width(png, info));
+        const int fileHeight = static_cast<int>(png_get_image_height(png, info));
+        const int nFileChannels = png_get_channels(png, info);
+        const int bitDepth = png_get_bit_depth(png, info);
+        if (fileWidth != width || fileHeight != height || nFileChannels != nChannels ||
+            bitDepth != bytesPerChannel * 8)
+        {
+            png_destroy_read_struct(&png, &info, nullptr);
+            throw std::runtime_error(std::format(
+                "Decoded a {}x{} image with {} channels of {} bit",
+                fileWidth, fileHeight, nFileChannels, bitDepth
+            ));
+        }
+
+        const size_t rowSize = static_cast<size_t>(width) * nChannels * bytesPerChannel;
+        res.resize(rowSize * height);
+        rows.resize(height);
+        for (int y = 0; y < height; y++) {
+            rows[y] = res.data() + y * rowSize;
+        }
+        png_read_image(png, rows.data());
+        png_read_end(png, nullptr);
+        png_destroy_read_struct(&png, &info, nullptr);
+        return res;
+    }
+
+    // Returns the pixels of the \p image in the layout of a PNG file
+    std::vector<unsigned char> expectedPixels(const sgct::Image& image) {
+        const int width = image.size().x;
+        const int height = image.size().y;
+        const int nChannels = image.channels();
+        const int bpc = image.bytesPerChannel();
+        const size_t rowSize = static_cast<size_t>(width) * nChannels * bpc;
+        std::vector<unsigned char> res(rowSize * height);
+        for (int y = 0; y < height; y++) {
+            const unsigned char* src = image.data() + (height - 1 - y) * rowSize;
+            unsigned char* dst = res.data() + y * rowSize;
+            for (int x = 0; x < width; x++) {
+                for (int c = 0; c < nChannels; c++) {
+                    // The image stores BGR(A), the file RGB(A)
+                    const int srcChannel = (nChannels >= 3 && c < 3) ? 2 - c : c;
+                    const unsigned char* s = src + (x * nChannels + srcChannel) * bpc;
+                    unsigned char* d = dst + (x * nChannels + c) * bpc;
+                    for (int b = 0; b < bpc; b++) {
+                        // Little-endian in the image, big-endian in the file
+                        d[b] = s[bpc - 1 - b];
+                    }
+                }
+            }
+        }
+        return res;
+    }
+
+    // Returns the number of the first differing byte or -1 if \p a and \p b are equal
+    long long firstDifference(const std::vector<unsigned char>& a,
+                              const std::vector<unsigned char>& b)
+    {
+        if (a.size() != b.size()) {
+            return static_cast<long long>(std::min(a.size(), b.size()));
+        }
+        const auto it = std::mismatch(a.begin(), a.end(), b.begin());
+        return it.first == a.end() ? -1 : it.first - a.begin();
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--width" && hasValue) {
+                options.width = std::max(std::stoi(argv[++i]), 1);
+            }
+            else if (arg == "--height" && hasValue) {
+                options.height = std::max(std::stoi(argv[++i]), 1);
+            }
+            else if (arg == "--strips" && hasValue) {
+                options.nStrips = std::max(std::stoi(argv[++i]), 1);
+            }
+            else if (arg == "--level" && hasValue) {
+                options.level = std::clamp(std::stoi(argv[++i]), 0, 9);
+            }
+            else {
+                std::cout << "Unknown argument '" << arg << "'. See the top of "
+                    "pngroundtrip.cpp for the list of options\n";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (options.height < options.nStrips * 64) {
+        std::cout << std::format(
+            "Images with fewer than {} rows are not compressed in {} strips\n",
+            options.nStrips * 64, options.nStrips
+        );
+    }
+
+    // The pool has fewer workers than strips so that the calling thread takes some too
+    sgct::CapturePool pool(
+        std::max(options.nStrips / 2, 1),
+        1,
+        sgct::CapturePool::OverflowPolicy::Block
+    );
+    std::mt19937 rng(1234);
+    int nFailed = 0;
+    for (int bpc : { 1, 2 }) {
+        for (int nChannels : { 1, 3, 4 }) {
+            for (sgct::Image::PngFilter filter : {
+                    sgct::Image::PngFilter::None,
+                    sgct::Image::PngFilter::Sub,
+                    sgct::Image::PngFilter::Up
+                })
+            {
+                sgct::Image image;
+                image.setBytesPerChannel(bpc);
+                image.setChannels(nChannels);
+                image.setSize(sgct::ivec2{ options.width, options.height });
+                image.allocateOrResizeData();
+                // Mostly smooth gradients with some noise, so that the filters and the
+                // compression have something to do
+                const size_t nBytes =
+                    static_cast<size_t>(options.width) * options.height * nChannels * bpc;
+                for (size_t i = 0; i < nBytes; i++) {
+                    const size_t v = (i / (nChannels * bpc)) % 251 + (rng() % 8);
+                    image.data()[i] = static_cast<unsigned char>(v);
+                }
+                image.setPngCompressionLevel(options.level);
+                image.setPngFilter(filter);
+                const std::vector<unsigned char> expected = expectedPixels(image);
+
+                for (int nStrips : { 1, options.nStrips }) {
+                    image.setEncoderThreads(nStrips);
+                    image.setEncoderPool(nStrips > 1 ? &pool : nullptr);
+                    const std::string name = std::format(
+                        "{} bit, {} channels, filter {}, {} strips",
+                        bpc * 8, nChannels, static_cast<int>(filter), nStrips
+                    );
+                    try {
+                        const std::vector<unsigned char> file = image.encode("a.png");
+                        const std::vector<unsigned char> decoded = decodePng(
+                            file, options.width, options.height, nChannels, bpc
+                        );
+                        const long long diff = firstDifference(decoded, expected);
+                        if (diff >= 0) {
+                            std::cout << std::format(
+                                "FAILED {}: byte {} differs\n", name, diff
+                            );
+                            nFailed++;
+                        }
+                        else {
+                            std::cout << std::format(
+                                "ok     {}: {} bytes\n", name, file.size()
+                            );
+                        }
+                    }
+                    catch (const std::exception& e) {
+                        std::cout << std::format("FAILED {}: {}\n", name, e.what());
+                        nFailed++;
+                    }
+                }
+            }
+        }
+    }
+
+    if (nFailed > 0) {
+        std::cout << nFailed << " of the round trips failed\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
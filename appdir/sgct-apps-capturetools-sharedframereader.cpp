@@ -0,0 +1,110 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/image.h>
+#include <sgct/sharedframe.h>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Reads the frames that an application publishes through shared memory and reports once
+// per second how many frames arrived and how long after they were sent. The newest frame
+// can be saved as an image, which shows whether the frames arrive intact
+
+namespace {
+    double steadyTime() {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cout << "Usage: sharedframereader <name> [--seconds <n>] [--save <file>]\n";
+        return EXIT_FAILURE;
+    }
+
+    const std::string name = argv[1];
+    double seconds = 10.0;
+    std::filesystem::path saveFile;
+    for (int i = 2; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc) {
+            seconds = std::stod(argv[++i]);
+        }
+        else if (arg == "--save" && i + 1 < argc) {
+            saveFile = argv[++i];
+        }
+        else {
+            std::cerr << "Unknown argument " << arg << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        sgct::SharedFrameReader reader(name);
+        sgct::Image image;
+        bool hasImage = false;
+
+        const double start = steadyTime();
+        double reportTime = start + 1.0;
+        int nFrames = 0;
+        int nSkipped = 0;
+        double latency = 0.0;
+        uint64_t lastFrameNumber = 0;
+        while (steadyTime() - start < seconds) {
+            if (!reader.read(image)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+            else {
+                latency += steadyTime() - reader.timestamp();
+                const uint64_t frameNumber = reader.frameNumber();
+                if (hasImage && frameNumber > lastFrameNumber + 1) {
+                    nSkipped += static_cast<int>(frameNumber - lastFrameNumber - 1);
+                }
+                lastFrameNumber = frameNumber;
+                hasImage = true;
+                nFrames++;
+            }
+
+            if (steadyTime() >= reportTime) {
+                std::cout << nFrames << " frames";
+                if (nFrames > 0) {
+                    std::cout << ", " << image.size().x << 'x' << image.size().y
+                        << ", latency " << latency / nFrames * 1000.0 << " ms";
+                }
+                std::cout << ", " << nSkipped << " skipped\n";
+                reportTime += 1.0;
+                nFrames = 0;
+                nSkipped = 0;
+                latency = 0.0;
+            }
+        }
+
+        if (!saveFile.empty()) {
+            if (!hasImage) {
+                std::cerr << "No frame was received from " << name << '\n';
+                return EXIT_FAILURE;
+            }
+            image.save(saveFile);
+            std::cout << "Saved frame " << lastFrameNumber << " to " << saveFile.string()
+                << '\n';
+        }
+    }
+    catch (const std::runtime_error& e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
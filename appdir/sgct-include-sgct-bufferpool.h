@@ -0,0 +1,132 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__BUFFERPOOL__H__
+#define __SGCT__BUFFERPOOL__H__
+
+#include <sgct/sgctexports.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * Recycles the large buffers that hold the pixel data of images. Requested sizes are
+ * rounded up to a bucket size and buffers that are released are kept for the next
+ * request of the same bucket, so that images of the same or similar size, for example
+ * after a window was resized back or when the capture switches between eyes, neither
+ * allocate nor page fault. All buffers are aligned to at least 64 bytes. The pool can be
+ * used from multiple threads.
+ */
+class SGCT_EXPORT BufferPool {
+public:
+    struct Settings {
+        /// The pool frees released buffers instead of keeping them once it holds this
+        /// many bytes of unused buffers, which is enough for two 4K frames with alpha
+        uint64_t maxCachedBytes = uint64_t(64) << 20;
+
+        /// Unused buffers that were not requested again for this many seconds are freed
+        /// the next time a buffer is acquired or released
+        double maxIdleTime = 10.0;
+
+        /// If `true`, every page of a new buffer is touched when it is allocated, so
+        /// that the page faults happen in the allocation instead of at the first use
+        bool prefault = false;
+
+        /// If `true`, buffers of at least 2 MiB are aligned to 2 MiB and marked for
+        /// transparent huge pages, which reduces the number of page faults and TLB
+        /// misses. This is only supported on Linux and ignored elsewhere
+        bool useHugePages = false;
+    };
+
+    struct Statistics {
+        /// The number of requests that were served with a recycled buffer
+        uint64_t nHits = 0;
+        /// The number of requests for which a new buffer was allocated
+        uint64_t nMisses = 0;
+        /// The number of bytes in buffers that are currently in use
+        uint64_t nBytesInUse = 0;
+        /// The number of bytes in unused buffers that are kept for later requests
+        uint64_t nBytesCached = 0;
+    };
+
+    /**
+     * Returns the pool that is used for the pixel data of all images.
+     */
+    static BufferPool& instance();
+
+    /**
+     * Sets the settings of the pool. Buffers that were already allocated keep the
+     * settings with which they were created.
+     */
+    void setSettings(Settings settings);
+    Settings settings() const;
+
+    /**
+     * Returns a buffer with at least \p size bytes that is aligned to 64 bytes. The
+     * content of the buffer is undefined. The buffer has to be given back with release.
+     */
+    unsigned char* acquire(size_t size);
+
+    /**
+     * Gives the \p buffer, which has to come from acquire, back to the pool.
+     */
+    void release(unsigned char* buffer);
+
+    /**
+     * Frees all buffers that are not in use.
+     */
+    void clear();
+
+    /**
+     * Frees the unused buffers that were released longer than `Settings::maxIdleTime`
+     * seconds ago.
+     */
+    void trim();
+
+    Statistics statistics() const;
+
+private:
+    BufferPool() = default;
+    ~BufferPool() = default;
+
+    struct Allocation {
+        size_t size = 0;
+        bool usesHugePages = false;
+    };
+
+    struct CachedBuffer {
+        unsigned char* buffer = nullptr;
+        /// The time at which the buffer was released, in seconds of the steady clock
+        double releaseTime = 0.0;
+    };
+
+    size_t bucketSize(size_t size) const;
+    /// Removes the buffers that are idle for too long from the cache and adds them to
+    /// \p expired. Has to be called while holding the lock
+    void collectExpired(double now, std::vector<unsigned char*>& expired);
+    static unsigned char* allocate(const Allocation& allocation);
+    static void deallocate(unsigned char* buffer);
+
+    mutable std::mutex _mutex;
+    Settings _settings;
+    /// The unused buffers, sorted by their bucket size
+    std::map<size_t, std::vector<CachedBuffer>> _cached;
+    /// All buffers of the pool, both in use and unused
+    std::unordered_map<unsigned char*, Allocation> _allocations;
+    Statistics _statistics;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__BUFFERPOOL__H__
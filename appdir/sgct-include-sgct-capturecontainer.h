@@ -0,0 +1,162 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CAPTURECONTAINER__H__
+#define __SGCT__CAPTURECONTAINER__H__
+
+#include <sgct/sgctexports.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace sgct {
+
+class Image;
+
+/**
+ * The on-disk layout of a capture container. A container starts with a `Header`,
+ * followed by the frames. Each frame is preceded by a copy of its `Entry` so that the
+ * frames can be recovered if the index was never written. The index with all entries is
+ * written after the last frame when the container is closed.
+ */
+namespace capturecontainer {
+    /// The codecs that can be used for the frames in a container
+    enum class Codec : uint8_t {
+        /// Bottom-up BGR(A) pixel data, the same layout as `Image::data`
+        Raw = 0,
+        /// A complete QOI image
+        QOI = 1,
+        /// Bottom-up BGR(A) pixel data with half or single precision floating-point
+        /// channels, depending on the bytes per channel
+        RawFloat = 2
+    };
+
+    struct Header {
+        char magic[8] = { 'S', 'G', 'C', 'T', 'C', 'A', 'P', '1' };
+        uint64_t indexOffset = 0;
+        uint64_t nEntries = 0;
+        uint64_t dataEnd = 0;
+    };
+
+    struct Entry {
+        uint64_t frameNumber = 0;
+        /// The location of the frame data in bytes from the beginning of the file
+        uint64_t offset = 0;
+        /// The size of the frame data in bytes
+        uint64_t size = 0;
+        int32_t windowId = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+        /// The `ScreenCapture::EyeIndex` of the frame
+        uint8_t eye = 0;
+        Codec codec = Codec::Raw;
+        uint8_t nChannels = 0;
+        uint8_t bytesPerChannel = 0;
+    };
+    static_assert(sizeof(Header) == 32);
+    static_assert(sizeof(Entry) == 40);
+} // namespace capturecontainer
+
+/**
+ * Appends captured frames into a single preallocated file that is memory mapped. Frames
+ * can be appended from multiple threads at the same time; each call reserves its region
+ * of the file and copies the data without holding a lock. The file grows when needed.
+ */
+class SGCT_EXPORT CaptureContainerWriter {
+public:
+    /**
+     * Creates the file at \p path and preallocates \p initialSize bytes for it. An
+     * existing file at that location is overwritten.
+     */
+    CaptureContainerWriter(std::filesystem::path path, uint64_t initialSize);
+
+    /**
+     * Writes the index, truncates the file to the used size and closes it.
+     */
+    ~CaptureContainerWriter();
+
+    CaptureContainerWriter(const CaptureContainerWriter&) = delete;
+    CaptureContainerWriter& operator=(const CaptureContainerWriter&) = delete;
+
+    /**
+     * Appends the \p size bytes at \p data as a new frame. The `offset` and `size` of the
+     * \p entry are set by this function. Throws an Error if the file could not be grown,
+     * in which case the frame is not added to the index.
+     */
+    void append(capturecontainer::Entry entry, const unsigned char* data, uint64_t size);
+
+    const std::filesystem::path& path() const;
+
+private:
+    /// Makes sure that the file is at least \p size bytes. Requires the exclusive lock
+    void grow(uint64_t size);
+
+    const std::filesystem::path _path;
+
+    /// Guards the reservation of new regions and the index
+    std::mutex _mutex;
+    /// Held shared while copying frame data and exclusively while remapping the file
+    std::shared_mutex _mappingMutex;
+
+    std::vector<capturecontainer::Entry> _entries;
+    uint64_t _end = 0;
+    uint64_t _capacity = 0;
+
+#ifdef WIN32
+    void* _file = nullptr;
+    void* _fileMapping = nullptr;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    int _file = -1;
+#endif // WIN32
+    unsigned char* _mapping = nullptr;
+};
+
+/**
+ * Provides read access to the frames in a capture container.
+ */
+class SGCT_EXPORT CaptureContainerReader {
+public:
+    /**
+     * Opens the container at \p path. If the container was not closed properly and has
+     * no index, the frames are recovered from the entries that precede each frame.
+     */
+    explicit CaptureContainerReader(const std::filesystem::path& path);
+    ~CaptureContainerReader();
+
+    CaptureContainerReader(const CaptureContainerReader&) = delete;
+    CaptureContainerReader& operator=(const CaptureContainerReader&) = delete;
+
+    const std::vector<capturecontainer::Entry>& entries() const;
+
+    /**
+     * Returns a pointer to the data of the frame described by the \p entry. The pointer
+     * remains valid for the lifetime of this reader.
+     */
+    const unsigned char* data(const capturecontainer::Entry& entry) const;
+
+    /**
+     * Decodes the frame described by \p entry into the \p image.
+     */
+    void read(const capturecontainer::Entry& entry, Image& image) const;
+
+private:
+    std::vector<capturecontainer::Entry> _entries;
+    const unsigned char* _data = nullptr;
+    uint64_t _size = 0;
+#ifdef WIN32
+    void* _file = nullptr;
+    void* _fileMapping = nullptr;
+#endif // WIN32
+};
+
+} // namespace sgct
+
+#endif // __SGCT__CAPTURECONTAINER__H__
@@ -0,0 +1,120 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CAPTUREPOOL__H__
+#define __SGCT__CAPTUREPOOL__H__
+
+#include <sgct/sgctexports.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * A fixed set of long-lived worker threads that process jobs from a bounded queue. Jobs
+ * can be added from multiple threads. This class is used by the ScreenCapture to encode
+ * and write captured frames without creating a new thread for every frame.
+ */
+class SGCT_EXPORT CapturePool {
+public:
+    /**
+     * Determines what happens to a job that is added while the queue is full.
+     */
+    enum class OverflowPolicy {
+        /// The calling thread waits until there is room in the queue
+        Block,
+        /// The oldest job in the queue is discarded to make room for the new job
+        DropOldest,
+        /// The new job is discarded
+        DropNewest
+    };
+
+    using Job = std::function<void()>;
+
+    /**
+     * Starts \p nThreads worker threads that share a queue that can hold at most
+     * \p queueLength jobs that are not yet being processed.
+     */
+    CapturePool(unsigned int nThreads, size_t queueLength, OverflowPolicy policy);
+
+    /**
+     * Processes all jobs that are still in the queue and then joins the worker threads.
+     */
+    ~CapturePool();
+
+    CapturePool(const CapturePool&) = delete;
+    CapturePool& operator=(const CapturePool&) = delete;
+
+    /**
+     * Adds the \p job to the queue. If the queue is full, the overflow policy decides
+     * whether this call waits or which job is discarded. Discarded jobs are destroyed
+     * without being executed.
+     *
+     * \return `false` if the new job was discarded, `true` otherwise
+     */
+    bool enqueue(Job job);
+
+    /**
+     * Calls the \p task with every index from 0 to \p n - 1 and returns when all calls
+     * have finished. The calls are made on the calling thread and on the workers that
+     * are idle, and they neither count towards the queue length nor can be discarded.
+     * As the calling thread makes every call that no worker has started yet, this can
+     * also be used from within a job while all other workers are busy. If one of the
+     * calls throws, the first exception is rethrown after all calls have finished.
+     */
+    void runInParallel(int n, const std::function<void(int)>& task);
+
+    /**
+     * Changes what happens to jobs that are added while the queue is full. Jobs that are
+     * already waiting are not affected.
+     */
+    void setOverflowPolicy(OverflowPolicy policy);
+
+    /**
+     * Blocks until the queue is empty and no worker is processing a job.
+     */
+    void waitForIdle();
+
+    /**
+     * Returns the number of jobs that are waiting in the queue.
+     */
+    size_t queueDepth() const;
+
+    /**
+     * Returns the total number of jobs that were discarded due to a full queue.
+     */
+    uint64_t nDroppedJobs() const;
+
+private:
+    void worker();
+
+    const size_t _queueLength;
+    OverflowPolicy _policy;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _jobAdded;
+    std::condition_variable _jobFinished;
+    std::deque<Job> _queue;
+    /// The jobs of runInParallel, which the workers prefer over the jobs in the queue
+    std::deque<Job> _helperJobs;
+    size_t _nActiveJobs = 0;
+    uint64_t _nDroppedJobs = 0;
+    bool _shouldStop = false;
+
+    std::vector<std::thread> _workers;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__CAPTUREPOOL__H__
@@ -0,0 +1,88 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CAPTURESTATISTICSRENDERER__H__
+#define __SGCT__CAPTURESTATISTICSRENDERER__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/engine.h>
+#include <sgct/math.h>
+#include <sgct/shaderprogram.h>
+#include <sgct/statisticshistory.h>
+#include <array>
+
+namespace sgct {
+
+/**
+ * Draws the capture histories of the Engine::Statistics as a graph in the top right
+ * corner of the viewports. The Engine shows it together with the StatisticsRenderer and
+ * applies the same scale and offset to both, and the windows draw it right after the
+ * StatisticsRenderer. The readback wait (red), encode (green), and
+ * write (blue) times use the same scale as the frame time graph, where the full height is
+ * 1/30 s, and the lines mark 60 and 30 Hz. The queue depth (yellow) uses the full height
+ * for a full queue, and a frame in which captured frames were dropped is marked with a
+ * spike over the full height (magenta).
+ */
+class SGCT_EXPORT CaptureStatisticsRenderer {
+public:
+    explicit CaptureStatisticsRenderer(const Engine::Statistics& statistics);
+    ~CaptureStatisticsRenderer();
+
+    CaptureStatisticsRenderer(const CaptureStatisticsRenderer&) = delete;
+    CaptureStatisticsRenderer& operator=(const CaptureStatisticsRenderer&) = delete;
+
+    /**
+     * Writes the values of the histories into the vertex buffer. Has to be called once
+     * per frame with the shared context being current.
+     */
+    void update();
+
+    /**
+     * Draws the graph into the current OpenGL viewport.
+     */
+    void render() const;
+
+    float scale() const;
+    void setScale(float scale);
+
+    vec2 offset() const;
+    void setOffset(vec2 offset);
+
+private:
+    struct Vertex {
+        float x = 0.f;
+        float y = 0.f;
+    };
+    static constexpr int Length = StatisticsHistory::HistoryLength;
+
+    /// The order of the histories in the vertex buffer
+    enum Series { QueueDepth = 0, ReadbackWait, Encode, Write, Dropped, NSeries };
+
+    const Engine::Statistics& _statistics;
+
+    ShaderProgram _shader;
+    int _mvpLoc = -1;
+    int _colorLoc = -1;
+
+    /// The background quad followed by the 0, 60 Hz, and 30 Hz lines
+    unsigned int _staticVao = 0;
+    unsigned int _staticVbo = 0;
+
+    /// The line strips of the histories in the order of `Series`
+    unsigned int _dynamicVao = 0;
+    unsigned int _dynamicVbo = 0;
+    std::array<Vertex, NSeries * Length> _vertices;
+
+    float _scale = 1.f;
+    vec2 _offset = vec2{ 0.f, 0.f };
+};
+
+} // namespace sgct
+
+#endif // __SGCT__CAPTURESTATISTICSRENDERER__H__
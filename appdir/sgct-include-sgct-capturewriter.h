@@ -0,0 +1,148 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CAPTUREWRITER__H__
+#define __SGCT__CAPTUREWRITER__H__
+
+#include <sgct/sgctexports.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * Writes the files that the capture threads have encoded from a single writer thread, so
+ * that the capture threads neither block on the disk nor compete with each other for
+ * it. On Linux, the writes of many files are submitted together through an io_uring,
+ * which keeps the disk busy with many writes in flight and few system calls. Elsewhere,
+ * or if the kernel does not support io_uring, the writer thread writes the files one
+ * after the other. The writer can be used from multiple threads.
+ */
+class SGCT_EXPORT CaptureWriter {
+public:
+    enum class Backend {
+        /// The writes are submitted through an io_uring
+        IoUring,
+        /// The writer thread writes the files with blocking calls
+        WriterThread
+    };
+
+    struct Settings {
+        /// If `true`, the io_uring is used if the kernel supports it
+        bool useIoUring = true;
+
+        /// The maximum number of writes that are in flight at the same time
+        int queueDepth = 32;
+
+        /// Files are written in pieces of at most this many bytes, so that the pieces of
+        /// a large file are written concurrently. Rounded up to a multiple of 4096
+        size_t chunkSize = size_t(1) << 20;
+
+        /// If `true`, the files are opened with `O_DIRECT` and bypass the page cache,
+        /// which avoids that the captured frames push everything else out of memory.
+        /// The data is copied into an aligned buffer that is padded to a multiple of
+        /// 4096 bytes and the file is truncated to its real size afterwards. Only
+        /// supported on Linux and ignored by file systems that do not support it
+        bool useDirectIO = false;
+
+        /// If `true`, the space of each file is allocated before it is written, so that
+        /// the file system neither fragments the file nor updates its size with every
+        /// write. Only supported on Linux
+        bool preallocate = true;
+
+        /// Adding a file waits while the files that have not been written yet take up
+        /// more than this many bytes
+        uint64_t maxQueuedBytes = uint64_t(512) << 20;
+    };
+
+    /**
+     * Starts the writer thread and sets up the io_uring if it is requested in the
+     * \p settings and supported, otherwise the files are written with blocking calls.
+     */
+    explicit CaptureWriter(Settings settings);
+
+    /**
+     * Writes all files that have been added and then stops the writer thread.
+     */
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * Adds the encoded \p data as the content of the file \p filename, which is replaced
+     * if it exists. The file is written asynchronously and errors are logged. This waits
+     * if too many bytes are waiting to be written and can be called from any thread.
+     */
+    void write(std::filesystem::path filename, std::vector<unsigned char> data);
+
+    /**
+     * Waits until all files that have been added so far are written.
+     */
+    void flush();
+
+    Backend backend() const;
+
+    /**
+     * Returns the number of files that could not be written.
+     */
+    uint64_t nFailedFiles() const;
+
+private:
+    struct File;
+    struct Ring;
+
+    /// The function of the writer thread
+    void run();
+
+    /// Submits the next pieces of the \p files to the io_uring, waits for at least one
+    /// piece to be written and finishes the files that are done
+    void writeRing(std::list<File>& files);
+
+    /// Writes the \p file with blocking calls
+    void writeBlocking(File& file);
+
+    /// Creates the \p file and allocates its space. Not used on Windows
+    bool open(File& file);
+    /// Truncates and closes the \p file and removes it if it could not be written
+    void close(File& file);
+
+    /// Releases the space of the \p file in the queue after it has been closed
+    void finish(const File& file);
+
+    const Settings _settings;
+    const size_t _chunkSize;
+    std::unique_ptr<Ring> _ring;
+    Backend _backend = Backend::WriterThread;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _hasFiles;
+    std::condition_variable _hasSpace;
+    std::condition_variable _isDone;
+    /// The files that have been added but not yet been taken by the writer thread
+    std::list<File> _queue;
+    /// The number of bytes of all files that have not been finished yet
+    uint64_t _nQueuedBytes = 0;
+    uint64_t _nUnfinishedFiles = 0;
+    uint64_t _nFailedFiles = 0;
+    bool _isStopping = false;
+
+    std::thread _thread;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__CAPTUREWRITER__H__
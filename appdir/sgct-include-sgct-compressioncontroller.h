@@ -0,0 +1,76 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__COMPRESSIONCONTROLLER__H__
+#define __SGCT__COMPRESSIONCONTROLLER__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/image.h>
+#include <cstddef>
+#include <mutex>
+
+namespace sgct {
+
+/**
+ * Chooses the zlib level and the filter for captured PNG frames so that compressing a
+ * frame stays within a time budget. The capture threads report how long each frame took
+ * and the ScreenCapture reports how many frames are waiting in the capture queue. If the
+ * frames take longer than the budget or the queue fills up, faster settings are used;
+ * if there is plenty of time left and the queue is empty, settings that produce smaller
+ * files are used. The controller can be used from multiple threads.
+ */
+class SGCT_EXPORT CompressionController {
+public:
+    struct Setting {
+        int level = 1;
+        Image::PngFilter filter = Image::PngFilter::None;
+
+        bool operator==(const Setting&) const = default;
+    };
+
+    /**
+     * Creates a controller that keeps the compression of a single frame below
+     * \p budget seconds for a capture queue that holds up to \p queueLength frames. The
+     * controller starts with the step that is closest to the \p initial setting.
+     */
+    CompressionController(double budget, size_t queueLength, Setting initial);
+
+    /**
+     * Returns the setting that should be used for the next frame.
+     */
+    Setting current() const;
+
+    /**
+     * Reports that compressing a frame with the \p setting took \p duration seconds.
+     * This can be called from any thread.
+     */
+    void reportDuration(const Setting& setting, double duration);
+
+    /**
+     * Reports the number of frames that are currently waiting in the capture queue.
+     */
+    void reportQueueDepth(size_t depth);
+
+private:
+    /// Switches to faster or smaller settings if needed. Requires the `_mutex` lock
+    void update();
+
+    const double _budget;
+    const size_t _queueLength;
+
+    mutable std::mutex _mutex;
+    int _step = 0;
+    double _averageDuration = 0.0;
+    int _nSamples = 0;
+    size_t _queueDepth = 0;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__COMPRESSIONCONTROLLER__H__
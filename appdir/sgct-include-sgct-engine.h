@@ -0,0 +1,353 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__ENGINE__H__
+#define __SGCT__ENGINE__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/actions.h>
+#include <sgct/callbackdata.h>
+#include <sgct/config.h>
+#include <sgct/keys.h>
+#include <sgct/math.h>
+#include <sgct/modifiers.h>
+#include <sgct/mouse.h>
+#include <sgct/statisticshistory.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct GLFWwindow;
+
+namespace sgct {
+
+class CaptureStatisticsRenderer;
+class Node;
+class StatisticsRenderer;
+class User;
+class Window;
+struct Configuration;
+
+/**
+ * Loads the cluster configuration from the file at \p path or creates the default
+ * configuration with a single window if no path is provided.
+ */
+SGCT_EXPORT config::Cluster loadCluster(
+    std::optional<std::filesystem::path> path = std::nullopt);
+
+/**
+ * Returns the time in seconds since GLFW was initialized.
+ */
+SGCT_EXPORT double time();
+
+/**
+ * The Engine class is the central part of SGCT and handles most of the callbacks,
+ * rendering, network handling, input devices etc.
+ */
+class SGCT_EXPORT Engine {
+public:
+    /**
+     * The timings that the Engine measures every frame, and the capture timings of all
+     * ScreenCapture objects of this node. Each history keeps the last `HistoryLength`
+     * values and can be indexed with the newest value first.
+     */
+    struct SGCT_EXPORT Statistics {
+        static constexpr int HistoryLength = StatisticsHistory::HistoryLength;
+
+        StatisticsHistory frametimes;
+        StatisticsHistory drawTimes;
+        StatisticsHistory syncTimes;
+        StatisticsHistory loopTimeMin;
+        StatisticsHistory loopTimeMax;
+
+        /// The number of captured frames of all ScreenCapture objects of this node that
+        /// are waiting for a capture thread. The capture histories are updated by
+        /// ScreenCapture::processPendingReadbacks while there are ScreenCapture objects
+        StatisticsHistory captureQueueDepth;
+
+        /// The time in seconds that the render thread waited for readbacks to arrive
+        StatisticsHistory captureReadbackWaitTimes;
+
+        /// The average time in seconds that the capture threads needed to encode a
+        /// frame, for the frames that were finished during this frame. The previous
+        /// value is repeated if no frame was finished. Frames that are read in bands
+        /// are compressed while they are written and are not included
+        StatisticsHistory captureEncodeTimes;
+
+        /// The average time in seconds that the capture threads needed to write a frame
+        /// or to hand it to the CaptureWriter, like `captureEncodeTimes`
+        StatisticsHistory captureWriteTimes;
+
+        /// The total number of captured frames that were dropped because the queue was
+        /// full
+        StatisticsHistory droppedCaptureFrames;
+
+        /**
+         * Returns the duration of the last frame and the average, minimum, and maximum
+         * of the frame times in the history, in seconds.
+         */
+        double dt() const;
+        double avgDt() const;
+        double minDt() const;
+        double maxDt() const;
+
+        /**
+         * Returns the 50th, 95th, and 99th percentile of the frame, draw, and sync times
+         * in the history, in seconds. Each call sorts a copy of the history partially.
+         */
+        StatisticsHistory::Percentiles frameTimePercentiles() const;
+        StatisticsHistory::Percentiles drawTimePercentiles() const;
+        StatisticsHistory::Percentiles syncTimePercentiles() const;
+    };
+
+    /**
+     * The settings of the Engine that are created from the cluster configuration and the
+     * command line arguments.
+     */
+    struct Settings {
+        /// Creates the OpenGL contexts with debug output
+        bool createDebugContext = false;
+
+        /// The swap interval of the windows, 0 disables the vertical sync
+        int swapInterval = 1;
+
+        /// Creates the depth, normal, and position textures for the windows
+        bool useDepthTexture = false;
+        bool useNormalTexture = false;
+        bool usePositionTexture = false;
+
+        /// Screenshots are read from the back buffer instead of the window's textures
+        bool captureBackBuffer = false;
+
+        /// Logs the state of the synchronization while a node waits for the others
+        bool printSyncMessage = true;
+
+        /// The time in seconds after which waiting for the other nodes is an error
+        float syncTimeout = 60.f;
+
+        struct Capture {
+            /// The number of threads that write screenshots
+            int nCaptureThreads = 1;
+
+            /// The folder that the screenshots are written to
+            std::filesystem::path capturePath;
+
+            /// The prefix of the names of the screenshot files
+            std::string prefix;
+
+            /// Adds the name of the node or window to the names of the screenshot files
+            bool addNodeName = false;
+            bool addWindowName = true;
+
+            /// The first and last frame that are captured, all frames if not set
+            std::optional<std::pair<uint64_t, uint64_t>> limits;
+        };
+        Capture capture;
+    };
+
+    using DrawFunction = std::function<void(const RenderData&)>;
+
+    /**
+     * The functions that the Engine calls during a frame and for the input events. All
+     * of them are optional.
+     */
+    struct Callbacks {
+        /// Called before the windows are created
+        std::function<void()> preWindow;
+        /// Called once with the shared context after the windows are created
+        std::function<void(GLFWwindow*)> initOpenGL;
+        /// Called at the beginning of a frame before the data is synchronized
+        std::function<void()> preSync;
+        /// Called after the data is synchronized and before the windows are drawn
+        std::function<void()> postSyncPreDraw;
+        /// Called for every viewport and eye of the windows
+        DrawFunction draw;
+        /// Called for every viewport of the windows after the 3D rendering
+        DrawFunction draw2D;
+        /// Called after all windows are drawn and before the buffers are swapped
+        std::function<void()> postDraw;
+        /// Called before the windows are closed
+        std::function<void()> cleanup;
+
+        /// Returns the data that the master synchronizes to the clients
+        std::function<std::vector<std::byte>()> encode;
+        /// Receives the data that the master synchronized on the clients
+        std::function<void(const std::vector<std::byte>&)> decode;
+
+        std::function<void(Key, Modifier, Action, int, Window*)> keyboard;
+        std::function<void(unsigned int, int, Window*)> character;
+        std::function<void(MouseButton, Modifier, Action, Window*)> mouseButton;
+        std::function<void(double, double, Window*)> mousePos;
+        std::function<void(double, double, Window*)> mouseScroll;
+        std::function<void(std::vector<std::string_view>)> drop;
+
+        std::function<void(void*, int, int, int)> dataTransferDecode;
+        std::function<void(bool, int)> dataTransferStatus;
+        std::function<void(int, int)> dataTransferAcknowledge;
+    };
+
+    /**
+     * Returns the instance of the Engine, which has to be created before.
+     */
+    static Engine& instance();
+
+    /**
+     * Creates the Engine for the \p cluster, initializes the network and creates the
+     * windows of this node. The \p callbacks are called from the render loop.
+     */
+    static void create(config::Cluster cluster, Callbacks callbacks,
+        const Configuration& arg);
+
+    /**
+     * Destroys the Engine and closes all windows and network connections.
+     */
+    static void destroy();
+
+    /**
+     * Runs the render loop until the engine is terminated or all windows are closed.
+     */
+    void exec();
+
+    /**
+     * Ends the render loop after the current frame.
+     */
+    void terminate();
+
+    /**
+     * Returns `true` if this node is the master of the cluster.
+     */
+    bool isMaster() const;
+
+    /**
+     * Returns the number of the frame that is being rendered.
+     */
+    unsigned int currentFrameNumber() const;
+
+    /**
+     * Returns the statistics of the frames, which are updated every frame.
+     */
+    const Statistics& statistics() const;
+
+    float nearClipPlane() const;
+    float farClipPlane() const;
+    void setNearAndFarClippingPlanes(float nearClippingPlane, float farClippingPlane);
+
+    /**
+     * Returns the window that has the input focus or `nullptr` if no window has it.
+     */
+    const Window* focusedWindow() const;
+
+    /**
+     * Shows or hides the graphs of the statistics.
+     */
+    void setStatsGraphVisibility(bool value);
+
+    /**
+     * Returns the scale and offset of the graphs of the statistics, or -1 if they are
+     * not shown.
+     */
+    float statsGraphScale() const;
+    void setStatsGraphScale(float scale);
+    vec2 statsGraphOffset() const;
+    void setStatsGraphOffset(vec2 offset);
+
+    /**
+     * Captures the windows with the ids \p windowIds, or all windows if it is empty, at
+     * the end of the current frame.
+     */
+    void takeScreenshot(std::vector<int> windowIds = {});
+    void resetScreenshotNumber();
+    void setScreenshotNumber(unsigned int number);
+    unsigned int screenShotNumber() const;
+
+    /**
+     * Sets the folder that the screenshots are written to and resets the screenshot
+     * number.
+     */
+    void setCapturePath(std::filesystem::path path);
+    void setCaptureFromBackBuffer(bool state);
+
+    DrawFunction drawFunction() const;
+    DrawFunction draw2DFunction() const;
+
+    const Node& thisNode() const;
+    const std::vector<std::unique_ptr<Window>>& windows() const;
+    User& defaultUser();
+
+    /**
+     * Returns the renderer of the statistics graphs or `nullptr` if they are not shown.
+     */
+    StatisticsRenderer* statisticsRenderer();
+
+    /**
+     * Returns the renderer of the capture statistics graph, which is shown together with
+     * the statistics graphs, or `nullptr` if they are not shown. The windows draw it
+     * after the StatisticsRenderer in their 2D pass.
+     */
+    CaptureStatisticsRenderer* captureStatisticsRenderer();
+
+    const Settings& settings() const;
+
+private:
+    Engine(config::Cluster cluster, Callbacks callbacks, const Configuration& config);
+    ~Engine();
+
+    void initialize();
+
+    /**
+     * Synchronizes the data from the master and waits on the clients until it has
+     * arrived.
+     */
+    void frameLockPreStage();
+
+    /**
+     * Waits on the master until all clients have rendered the frame.
+     */
+    void frameLockPostStage();
+
+    void waitForAllWindowsInSwapGroupToOpen();
+    void updateFrustums() const;
+
+    static Engine* _instance;
+
+    std::function<void()> _preWindowFn;
+    std::function<void(GLFWwindow*)> _initOpenGLFn;
+    std::function<void()> _preSyncFn;
+    std::function<void()> _postSyncPreDrawFn;
+    DrawFunction _drawFn;
+    DrawFunction _draw2DFn;
+    std::function<void()> _postDrawFn;
+    std::function<void()> _cleanupFn;
+
+    Settings _settings;
+    Statistics _statistics;
+    double _statsPrevTimestamp = 0.0;
+    std::unique_ptr<StatisticsRenderer> _statisticsRenderer;
+    std::unique_ptr<CaptureStatisticsRenderer> _captureStatisticsRenderer;
+
+    float _nearClipPlane = 0.1f;
+    float _farClipPlane = 100.f;
+
+    bool _shouldTakeScreenshot = false;
+    std::vector<int> _shouldTakeScreenshotIds;
+    unsigned int _shotCounter = 0;
+    unsigned int _frameCounter = 0;
+    bool _shouldTerminate = false;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__ENGINE__H__
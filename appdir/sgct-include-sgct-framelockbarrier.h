@@ -0,0 +1,72 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__FRAMELOCKBARRIER__H__
+#define __SGCT__FRAMELOCKBARRIER__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/statisticshistory.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * The barrier at which the nodes of a cluster wait for each other once per frame: the
+ * clients wait for the data of the master and the master waits for the acknowledgements
+ * of the clients. The waiting thread sleeps on the condition variable that the network
+ * threads notify whenever a message arrives, so it continues as soon as the last node
+ * has arrived. While the wait takes long, diagnostics are printed once per second.
+ */
+class SGCT_EXPORT FrameLockBarrier {
+public:
+    /**
+     * The timings of the barrier, with one value per frame.
+     */
+    struct Statistics {
+        /// For each node, the time in seconds from the start of the wait until the node
+        /// had arrived. Nodes that arrived before the wait started have a latency of 0
+        std::vector<StatisticsHistory> nodeLatencies;
+
+        /// The number of times the waiting thread woke up before all nodes had arrived,
+        /// including the wakeups for the diagnostics
+        StatisticsHistory wakeups;
+    };
+
+    static const Statistics& statistics();
+
+    /**
+     * Creates a barrier that waits on the \p cond, which is notified by the threads that
+     * receive the messages of the nodes. These threads have to update the state that is
+     * checked by the barrier and notify the \p cond while holding the \p mutex.
+     */
+    FrameLockBarrier(std::mutex& mutex, std::condition_variable& cond);
+
+    /**
+     * Blocks until \p isComplete returns `true`, which is checked while holding the
+     * mutex after every wakeup. The \p hasArrived function is called with the indices
+     * from 0 to \p nNodes - 1 after every wakeup to record the latency of each node. The
+     * \p onStall function is called with the time in seconds since the wait started once
+     * per second while the wait continues, and it can throw to abort the wait.
+     */
+    void wait(int nNodes, const std::function<bool()>& isComplete,
+        const std::function<bool(int)>& hasArrived,
+        const std::function<void(double)>& onStall);
+
+private:
+    std::mutex& _mutex;
+    std::condition_variable& _cond;
+    std::vector<double> _latencies;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__FRAMELOCKBARRIER__H__
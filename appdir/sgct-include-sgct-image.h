@@ -0,0 +1,181 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__IMAGE__H__
+#define __SGCT__IMAGE__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/math.h>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace sgct {
+
+class CapturePool;
+
+class SGCT_EXPORT Image {
+public:
+    /**
+     * The filters that can be applied to the rows of a PNG before they are compressed.
+     * Filtering costs a little time, but usually makes the file noticeably smaller.
+     */
+    enum class PngFilter {
+        /// The rows are compressed as they are
+        None,
+        /// Each byte is stored as the difference to the same channel of the pixel left
+        Sub,
+        /// Each byte is stored as the difference to the same byte in the row above
+        Up
+    };
+
+    Image() = default;
+    ~Image();
+
+    /**
+     * Loads the image from the provided \p filename. The file is memory-mapped instead
+     * of being read into a buffer. QOI and PNG images are decoded directly into the
+     * layout of the pixel data, all other files are loaded with stb_image.
+     */
+    void load(const std::filesystem::path& filename);
+
+    /**
+     * Loads the image from \p length bytes of encoded data. Data that starts with the
+     * QOI or PNG signature is decoded as a QOI or PNG image, all other data with
+     * stb_image.
+     */
+    void load(unsigned char* data, int length);
+
+    /**
+     * Loads the images from the \p filenames on \p nThreads threads, or on one thread
+     * per core if \p nThreads is 0, and logs how long each image took. The images are
+     * returned in the order of the \p filenames. The image of a file that could not be
+     * loaded is `nullptr` and the error is logged.
+     */
+    static std::vector<std::unique_ptr<Image>> loadBatch(
+        const std::vector<std::filesystem::path>& filenames, int nThreads = 0);
+
+    /**
+     * Saves the image to the provided \p filename. If the extension is `.qoi`, the image
+     * is saved as an 8-bit QOI image, if it is `.exr`, the floating-point image is saved
+     * as a ZIP compressed OpenEXR file, otherwise it is saved as a PNG. Floating-point
+     * images can only be saved as EXR.
+     */
+    void save(const std::filesystem::path& filename);
+
+    /**
+     * Returns the image encoded in the format that save would use for \p filename,
+     * without writing it to disk.
+     */
+    std::vector<unsigned char> encode(const std::filesystem::path& filename) const;
+
+    /**
+     * Writes the \p data that encode returned to the file \p filename, which is replaced
+     * if it exists.
+     */
+    static void writeFile(const std::filesystem::path& filename,
+        const std::vector<unsigned char>& data);
+
+    /**
+     * Returns the image encoded as a QOI file. Only 8-bit images with 3 or 4 channels can
+     * be encoded as QOI.
+     */
+    std::vector<unsigned char> encodeQoi() const;
+
+    unsigned char* data();
+    const unsigned char* data() const;
+    int channels() const;
+    int bytesPerChannel() const;
+    bool isFloatingPoint() const;
+    ivec2 size() const;
+
+    void setSize(ivec2 size);
+    void setChannels(int channels);
+    void setBytesPerChannel(int bpc);
+
+    /**
+     * Marks the channels of the image as floating-point numbers instead of unsigned
+     * integers. Floating-point images have 2 (half precision) or 4 (single precision)
+     * bytes per channel. Loading an image resets this to `false`.
+     */
+    void setFloatingPoint(bool isFloat);
+
+    /**
+     * Sets the number of threads that are used to compress the pixel data when saving a
+     * PNG or an EXR. With more than one thread, the rows are split into horizontal strips
+     * that are compressed concurrently by the saving thread and the idle workers of the
+     * pool set with setEncoderPool, and written as a single valid image. Without a pool,
+     * the image is compressed on the saving thread only. The default is 1.
+     */
+    void setEncoderThreads(int nThreads);
+
+    /**
+     * Sets the \p pool whose idle workers help compressing the strips when saving. The
+     * pool has to outlive all calls to save. The default is `nullptr`.
+     */
+    void setEncoderPool(CapturePool* pool);
+
+    /**
+     * Sets the zlib compression level that is used when saving a PNG or an EXR, from 0
+     * (no compression) to 9 (best compression). The default is 1, which is the fastest
+     * level that still compresses.
+     */
+    void setPngCompressionLevel(int level);
+
+    /**
+     * Sets the filter that is used for all rows when saving a PNG. The default is
+     * PngFilter::None.
+     */
+    void setPngFilter(PngFilter filter);
+
+    /**
+     * Allocates the memory for the pixel data with the current size, number of channels,
+     * and bytes per channel, unless the image already has memory of that size. The
+     * memory comes from the BufferPool and is given back to it when the image is
+     * destroyed or reallocated.
+     */
+    void allocateOrResizeData();
+
+    /**
+     * Makes this image a view onto memory that is owned by someone else. The size,
+     * number of channels, and bytes per channel have to be set before and the memory
+     * pointed to by \p data has to be large enough and remain valid for as long as the
+     * image uses it. The memory is not freed by the image. Calling
+     * allocateOrResizeData afterwards replaces the view with owned memory.
+     *
+     * \param data The memory that holds the pixel data of this image
+     */
+    void setBorrowedData(unsigned char* data);
+
+private:
+    /// Returns `false` if the \p data is not an image in a supported format
+    bool decode(const unsigned char* data, size_t length);
+    std::vector<unsigned char> encodeParallelPng(int nStrips) const;
+    std::vector<unsigned char> encodeExr(const std::filesystem::path& filename) const;
+    void freeData();
+
+    int _nChannels = 0;
+    ivec2 _size = ivec2{ 0, 0 };
+    size_t _dataSize = 0;
+    int _bytesPerChannel = 0;
+    unsigned char* _data = nullptr;
+    bool _isDataBorrowed = false;
+    /// `true` if the pixel data was allocated from the BufferPool
+    bool _isDataPooled = false;
+    bool _isFloat = false;
+    int _nEncoderThreads = 1;
+    CapturePool* _encoderPool = nullptr;
+    int _pngCompressionLevel = 1;
+    PngFilter _pngFilter = PngFilter::None;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__IMAGE__H__
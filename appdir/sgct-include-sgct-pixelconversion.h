@@ -0,0 +1,71 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__PIXELCONVERSION__H__
+#define __SGCT__PIXELCONVERSION__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/math.h>
+#include <cstddef>
+#include <string_view>
+
+/**
+ * Conversions between the pixel layout that SGCT uses for images (bottom-up rows with
+ * BGR(A) channels in machine byte order) and the layouts of the image files. The
+ * functions use SSE2 or NEON and AVX2 if the CPU supports it, with a scalar fallback for
+ * all other cases.
+ */
+namespace sgct::pixelconversion {
+
+/**
+ * Swaps the first and third channel of \p nPixels 8-bit pixels with \p nChannels
+ * channels in place. Images with fewer than 3 channels are not changed.
+ */
+SGCT_EXPORT void swapRedBlue(unsigned char* data, size_t nPixels, int nChannels);
+
+/**
+ * Converts \p nPixels pixels from \p src into the channel and byte order that is used in
+ * PNG files and writes them to \p dst. The first and third channel are swapped if there
+ * are at least three channels and 16-bit channels are converted from little-endian to
+ * big-endian. \p src and \p dst may point to the same memory, but must not overlap
+ * otherwise.
+ */
+SGCT_EXPORT void convertToPngLayout(const unsigned char* src, unsigned char* dst,
+    size_t nPixels, int nChannels, int bytesPerChannel);
+
+/**
+ * Reverses the order of the \p nRows rows of \p rowSize bytes each in place.
+ */
+SGCT_EXPORT void flipVertically(unsigned char* data, size_t rowSize, size_t nRows);
+
+/**
+ * Flips the 8-bit image of size \p size vertically and swaps the first and third
+ * channel in a single pass over the memory. This converts a top-down RGB(A) image as it
+ * is loaded from a file into the layout that SGCT uses and vice versa.
+ */
+SGCT_EXPORT void flipAndSwapRedBlue(unsigned char* data, ivec2 size, int nChannels);
+
+/**
+ * Reduces the 8-bit image \p src of size \p size by the \p factor of 2, 4, or 8 in both
+ * directions and writes the result to \p dst, which has to hold
+ * `(size.x / factor) * (size.y / factor)` pixels. Each pixel of the result is the
+ * average of a block of `factor x factor` pixels. Pixels at the right and upper edges
+ * that do not fill a whole block are ignored.
+ */
+SGCT_EXPORT void downscale(const unsigned char* src, ivec2 size, int nChannels,
+    int factor, unsigned char* dst);
+
+/**
+ * Returns the name of the instruction set that is used for the conversions on this CPU.
+ */
+SGCT_EXPORT std::string_view instructionSet();
+
+} // namespace sgct::pixelconversion
+
+#endif // __SGCT__PIXELCONVERSION__H__
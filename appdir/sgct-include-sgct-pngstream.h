@@ -0,0 +1,101 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__PNGSTREAM__H__
+#define __SGCT__PNGSTREAM__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/math.h>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sgct {
+
+class Image;
+
+/**
+ * Writes a PNG file from horizontal bands of rows that arrive one after another, so that
+ * the full image never has to be in memory. The bands can be submitted from multiple
+ * threads, but are always compressed in the order in which they were reserved, starting
+ * with the top of the image. The file is complete as soon as the last band has been
+ * written. The stream has to be owned by a `shared_ptr`.
+ */
+class SGCT_EXPORT PngStream : public std::enable_shared_from_this<PngStream> {
+public:
+    /**
+     * Creates the file \p filename and writes the header of a PNG image with the size
+     * \p size. The bands that are submitted have to have \p nChannels channels with
+     * \p bytesPerChannel bytes each and are compressed with the zlib \p compressionLevel.
+     */
+    PngStream(std::filesystem::path filename, ivec2 size, int nChannels,
+        int bytesPerChannel, int compressionLevel);
+
+    /**
+     * Closes the file. If not all rows of the image were written, the incomplete file is
+     * removed.
+     */
+    ~PngStream();
+
+    PngStream(const PngStream&) = delete;
+    PngStream& operator=(const PngStream&) = delete;
+
+    /**
+     * Reserves the next band of the image. The band has to be passed to `submit` before
+     * the returned ticket is released. If the ticket is released without a band, the
+     * image can no longer be completed and all following bands are discarded.
+     */
+    std::shared_ptr<const int> reserveBand();
+
+    /**
+     * Writes the first \p nRows rows of the bottom-up BGR(A) \p band at the position
+     * \p index, or keeps the band until all previous bands have been written. This can be
+     * called from any thread.
+     */
+    void submit(int index, std::shared_ptr<const Image> band, int nRows);
+
+private:
+    struct Band {
+        std::shared_ptr<const Image> image;
+        int nRows = 0;
+    };
+
+    void skip(int index);
+
+    /// Writes the pending bands that are next in line. Requires the `_mutex` lock
+    void writePending(std::unique_lock<std::mutex>& lock);
+    void write(const Band& band);
+    void finish();
+
+    const std::filesystem::path _filename;
+    const ivec2 _size;
+    const int _nChannels;
+    const int _bytesPerChannel;
+    const double _startTime;
+    std::FILE* _file = nullptr;
+    void* _png = nullptr; // png_structp
+    void* _info = nullptr; // png_infop
+    std::vector<unsigned char> _row;
+    int _nRowsWritten = 0;
+
+    std::mutex _mutex;
+    /// Bands that wait for an earlier band. A band without an image was skipped
+    std::map<int, Band> _pending;
+    int _nextReserved = 0;
+    int _nextWritten = 0;
+    bool _isWriting = false;
+    bool _hasFailed = false;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__PNGSTREAM__H__
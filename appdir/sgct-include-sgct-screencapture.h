@@ -11,18 +11,26 @@
 
 #include <sgct/sgctexports.h>
 
+#include <sgct/capturecontainer.h>
+#include <sgct/capturepool.h>
+#include <sgct/capturewriter.h>
+#include <sgct/compressioncontroller.h>
+#include <sgct/engine.h>
+#include <sgct/image.h>
 #include <sgct/math.h>
-#include <atomic>
+#include <sgct/pngstream.h>
+#include <sgct/videostream.h>
+#include <array>
+#include <condition_variable>
 #include <cstdint>
+#include <filesystem>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace sgct {
 
-class Image;
 class Window;
 
 /**
@@ -34,42 +42,160 @@ public:
      * The different file formats supported.
      */
     enum class CaptureSource { Texture, BackBuffer, LeftBackBuffer, RightBackBuffer };
-    enum class EyeIndex { Mono, StereoLeft, StereoRight };
 
-    struct ScreenCaptureThreadInfo {
-        std::string filename;
-        std::unique_ptr<Image> frameBufferImage;
-        std::unique_ptr<std::thread> captureThread;
-        std::mutex* mutex = nullptr;
-        std::atomic_bool isRunning = false; // needed for test if running without join
-
-        ScreenCaptureThreadInfo() = default;
-        ScreenCaptureThreadInfo(const ScreenCaptureThreadInfo&) = delete;
-        ScreenCaptureThreadInfo& operator=(const ScreenCaptureThreadInfo&) = delete;
-
-        ScreenCaptureThreadInfo(ScreenCaptureThreadInfo&& other) noexcept
-            : filename(std::move(other.filename))
-            , frameBufferImage(std::move(other.frameBufferImage))
-            , captureThread(std::move(other.captureThread))
-            , mutex(other.mutex)
-            , isRunning(other.isRunning.load(std::memory_order_relaxed))
-        {}
-
-        ScreenCaptureThreadInfo& operator=(ScreenCaptureThreadInfo&& other) noexcept {
-            if (this != &other) {
-                filename = std::move(other.filename);
-                frameBufferImage = std::move(other.frameBufferImage);
-                captureThread = std::move(other.captureThread);
-                mutex = other.mutex;
-                isRunning.store(
-                    other.isRunning.load(std::memory_order_relaxed),
-                    std::memory_order_relaxed
-                );
-            }
-            return *this;
-        }
+    /**
+     * The eye that is captured. A capture with `Stereo` reads both eyes into a single
+     * frame that is arranged according to the `stereoLayout` setting, so that a stereo
+     * frame only needs one readback, one capture job, and one file.
+     */
+    enum class EyeIndex { Mono, StereoLeft, StereoRight, Stereo };
+
+    /**
+     * The arrangement of the eyes in the frames of a capture with `EyeIndex::Stereo`.
+     * With `SideBySide`, the left eye is in the left half of the frame, with
+     * `TopBottom`, the left eye is in the upper half of the frame.
+     */
+    enum class StereoLayout { SideBySide, TopBottom };
+
+    /**
+     * The file formats in which captured frames can be written. QOI is a lossless format
+     * that is much faster to encode than PNG and is meant for intermediate frames that
+     * are converted later. Y4M and RawRGB write all frames of a window as one
+     * uncompressed video stream that can be consumed by a video encoder. EXR stores the
+     * half or single precision floating-point frames of HDR windows without loss and is
+     * always used for them. PNG supports 8-bit and 16-bit frames, the other formats only
+     * support 8-bit frames, other frames use PNG.
+     */
+    enum class CaptureFormat { PNG, QOI, Y4M, RawRGB, EXR };
+
+    /**
+     * Settings that control how captured frames are processed after they have been read
+     * back from the GPU. They are applied when a ScreenCapture object is created.
+     */
+    struct Settings {
+        /// The maximum number of frames that are waiting for a capture thread
+        int queueLength = 4;
+
+        /// Determines what happens with a captured frame if the queue is full
+        CapturePool::OverflowPolicy overflowPolicy = CapturePool::OverflowPolicy::Block;
+
+        /// The number of frames whose readback can be in flight while the following
+        /// frames are rendered. Each frame needs its own pixel buffer, and a deeper ring
+        /// lets the rendering get further ahead of the GPU transfers
+        int readbackDepth = 3;
+
+        /// If `true`, the pixel buffers are mapped persistently and the encoder reads
+        /// directly from the mapped memory instead of from a copy. Each buffer is then
+        /// in use until its frame has been written, so more buffers are allocated
+        bool usePersistentMapping = false;
+
+        /// The number of strips in which a single PNG or EXR is compressed concurrently.
+        /// The strips are compressed by the capture thread of the frame and the capture
+        /// threads that are idle, of which there are at least this many, so this is
+        /// most useful for few, very large frames
+        int nEncoderThreads = 1;
+
+        /// The zlib compression level from 0 to 9 that is used for PNG and EXR files
+        int pngCompressionLevel = 1;
+
+        /// The filter that is applied to the rows of PNG files before compressing them
+        Image::PngFilter pngFilter = Image::PngFilter::None;
+
+        /// If larger than 0, the compression level and filter of PNG files are adapted
+        /// for every frame, so that the capture threads together keep up with one frame
+        /// in this many seconds, for example 1/60 to capture every frame at 60 Hz. The
+        /// level and filter above are used for the first frames. Not used for bands
+        double adaptivePngBudget = 0.0;
+
+        /// The file format in which the captured frames are written
+        CaptureFormat format = CaptureFormat::PNG;
+
+        /// If `true`, the frames of all windows of this node are appended to a single
+        /// memory-mapped container file instead of being written as individual files.
+        /// The frames are stored as QOI if that is the selected format and uncompressed
+        /// otherwise, which includes floating-point frames
+        bool useContainer = false;
+
+        /// The number of bytes that are preallocated for a new container file
+        uint64_t containerPreallocation = uint64_t(1) << 30;
+
+        /// If the format is a video format and this is not empty, the video stream of
+        /// each window is written to the standard input of this command instead of to a
+        /// file. `{name}` in the command is replaced with the file name that would have
+        /// been used for the stream, without the extension
+        std::string videoCommand;
+
+        /// The frame rate that is stored in the header of Y4M video streams
+        int videoFrameRate = 60;
+
+        /// If larger than 0, PNG frames are read back from the GPU in horizontal bands
+        /// of this many rows and each band is compressed into the file as soon as it
+        /// arrives. The pixel buffers and images then only hold a band instead of a
+        /// full frame, so that the memory for very large frames, such as 8K or 16K
+        /// fisheye masters, depends on the band size. Not used for containers
+        int bandHeight = 0;
+
+        /// If `true`, the Engine captures both eyes of stereo windows into a single frame
+        /// arranged by `stereoLayout` instead of one frame per eye
+        bool combineStereo = false;
+
+        /// The arrangement of the eyes in frames that contain both eyes
+        StereoLayout stereoLayout = StereoLayout::SideBySide;
+
+        /// If `true`, the capture threads only encode the frames and the files of all
+        /// windows are written by a single CaptureWriter, which batches the writes of
+        /// many files. Not used for bands, containers, and video streams
+        bool useCaptureWriter = false;
+
+        /// The settings of the CaptureWriter
+        CaptureWriter::Settings writer;
+
+        /// If this is 2, 4, or 8, a preview that is smaller than the frames by this
+        /// factor in both directions is computed from the frames that are read back and
+        /// written as a PNG file next to them, so that a recording can be monitored
+        /// without a second capture. Only supported for 8-bit frames not read in bands
+        int previewFactor = 1;
+
+        /// The preview is written for every frame whose number is a multiple of this
+        int previewInterval = 30;
     };
 
+    /**
+     * Sets the settings that are used for all ScreenCapture objects created afterwards.
+     */
+    static void setSettings(Settings settings);
+    static const Settings& settings();
+
+    /**
+     * Enables or disables the offline export, for example while a recorded session is
+     * played back and every frame is saved. During an offline export, no frame is dropped
+     * and the files do not depend on the timing: a full queue blocks the render thread
+     * instead of dropping frames, which bounds the frames in flight to the readbacks and
+     * the queue, and the PNG compression is not adapted. The readback and encoding of a
+     * frame still overlap with the rendering of the following frames. This applies to
+     * all ScreenCapture objects, also those that are created later. Every requested
+     * frame is captured as it was rendered, so waiting until all data of a frame has
+     * been loaded is up to the application.
+     */
+    static void setOfflineExport(bool enabled);
+    static bool isOfflineExport();
+
+    /**
+     * Maps and hands off all readbacks of all screen capture objects whose GPU fence has
+     * been signalled. This function never blocks and should be called once per frame so
+     * that a screenshot is written to disk even if no subsequent capture is requested.
+     * This also adds the capture timings of this frame to the \p statistics.
+     */
+    static void processPendingReadbacks(Engine::Statistics& statistics);
+
+    /**
+     * Creates a capture with `EyeIndex::Stereo` for the \p window that reads the same
+     * pixel format as the captures that the window created for its eyes. Returns
+     * `nullptr` if the window has no capture yet. The capture has to be resized before
+     * it is used.
+     */
+    static std::unique_ptr<ScreenCapture> createStereoCapture(const Window& window);
+
     ScreenCapture(const Window& window, ScreenCapture::EyeIndex ei, int bytesPerColor,
         unsigned int colorDataType, bool addAlpha);
     ~ScreenCapture();
@@ -77,7 +203,8 @@ public:
     /**
      * Initializes the PBO or re-sizes it if the frame buffer size have changed.
      *
-     * \param resolution The pixel resolution of the frame buffer
+     * \param resolution The pixel resolution of the frame buffer, which is the
+     *        resolution of a single eye for stereo captures
      */
     void resize(ivec2 resolution);
 
@@ -91,23 +218,149 @@ public:
     void saveScreenCapture(unsigned int textureId,
         CaptureSource capSrc = CaptureSource::Texture);
 
+    /**
+     * Saves both eyes as a single image. This can only be used if the object was created
+     * with `EyeIndex::Stereo`.
+     *
+     * \param leftTextureId The texture of the left eye if frame buffer objects are used
+     * \param rightTextureId The texture of the right eye if frame buffer objects are used
+     * \param capSrc If this is not `CaptureSource::Texture`, the eyes are read from the
+     *        left and right back buffers instead of the textures
+     */
+    void saveStereoScreenCapture(unsigned int leftTextureId, unsigned int rightTextureId,
+        CaptureSource capSrc = CaptureSource::Texture);
+
+    /**
+     * Returns the number of frames whose readback has been issued to the GPU but that
+     * have not yet been handed to a capture thread.
+     */
+    int framesInFlight() const;
+
+    /**
+     * Returns the time in seconds since the oldest readback that is still in flight was
+     * issued, or 0 if there are no readbacks in flight.
+     */
+    double oldestPendingReadbackAge() const;
+
 private:
+    /**
+     * One of the images that are read into a frame, which is the only eye of mono
+     * captures and either of the two eyes of stereo captures.
+     */
+    struct Source {
+        unsigned int textureId = 0;
+        CaptureSource capSrc = CaptureSource::Texture;
+    };
+
+    /**
+     * One entry in the ring of pixel buffer objects. The readback into the PBO is
+     * asynchronous and the fence is signalled once the GPU has finished writing to it.
+     */
+    struct ReadbackSlot {
+        unsigned int pbo = 0;
+        void* fence = nullptr; // GLsync, nullptr if the slot is not in flight
+        std::string filename;
+        uint64_t frameNumber = 0;
+        double timestamp = 0.0;
+
+        /// The persistent mapping of the PBO if persistent mapping is used
+        unsigned char* mapping = nullptr;
+        /// Whether an encoder is reading from the mapping. Guarded by the `_mutex`
+        bool isBorrowed = false;
+
+        /// The image and the position of the band in it if frames are read in bands
+        std::shared_ptr<PngStream> stream;
+        std::shared_ptr<const int> band;
+        int nRows = 0;
+    };
+
+    /**
+     * Reads the \p sources into the next frame. Mono captures use the first source only.
+     */
+    void capture(const std::array<Source, 2>& sources);
+
     std::string createFilename(uint64_t frameNumber);
-    int availableCaptureThread();
-    Image* prepareImage(int index, std::string file);
+    std::filesystem::path createContainerFilename() const;
+
+    /**
+     * Returns an image with the current resolution that is not used by any capture job.
+     * The image is returned to this object when the last reference to it is released.
+     */
+    std::shared_ptr<Image> acquireImage();
+
+    /**
+     * Returns an image with a copy of the pixels in the \p slot.
+     */
+    std::shared_ptr<Image> copyImage(const ReadbackSlot& slot);
+
+    /**
+     * Returns an image that refers to the persistently mapped memory of the \p slot. The
+     * slot cannot be used for a new readback until the image is released.
+     */
+    std::shared_ptr<Image> borrowImage(ReadbackSlot& slot);
+
+    void destroyBuffers();
+
+    /**
+     * Returns the slot for the next readback. If all slots are in flight, this waits
+     * for the oldest one and hands it to the capture threads.
+     */
+    ReadbackSlot& nextReadbackSlot();
+
+    /**
+     * Issues the asynchronous readback of \p nRows rows of the frame, starting at row
+     * \p y from the bottom, into the \p slot, which has to be the one from
+     * nextReadbackSlot. Each of the \p sources is read into its part of the frame.
+     */
+    void readPixels(ReadbackSlot& slot, const std::array<Source, 2>& sources, int y,
+        int nRows);
+
+    /**
+     * Hands off the readbacks that are in flight to the capture threads in the order in
+     * which they were issued. If \p waitForAll is `false`, this function stops at the
+     * first readback whose fence has not yet been signalled.
+     */
+    void collectReadbacks(bool waitForAll);
+    void finishReadback(ReadbackSlot& slot);
 
     std::mutex _mutex;
-    std::vector<ScreenCaptureThreadInfo> _captureInfos;
+    std::condition_variable _bufferReleased;
+    std::vector<std::unique_ptr<Image>> _freeImages;
+    std::shared_ptr<CaptureContainerWriter> _container;
+    std::shared_ptr<VideoStream> _videoStream;
+    std::shared_ptr<CompressionController> _compression;
+    std::shared_ptr<CaptureWriter> _writer;
+    std::unique_ptr<CapturePool> _pool;
+    /// The overflow policy of the pool when there is no offline export
+    const CapturePool::OverflowPolicy _overflowPolicy;
+    uint64_t _nReportedDroppedFrames = 0;
 
-    const unsigned int _nThreads;
-    unsigned int _pbo = 0;
+    std::vector<ReadbackSlot> _readbacks;
+    size_t _nextReadback = 0;
+    size_t _nReadbacksInFlight = 0;
     const unsigned int _downloadType;
-    int _dataSize = 0;
+    size_t _dataSize = 0;
+    /// The resolution of a frame, which contains both eyes for stereo captures
     ivec2 _resolution = ivec2{ 0, 0 };
+    /// The resolution of a single eye in the frame
+    ivec2 _eyeResolution = ivec2{ 0, 0 };
+    /// The number of rows of each readback, which is the height of the frame unless the
+    /// frame is read in bands
+    int _readbackRows = 0;
     const int _bytesPerColor;
+    /// `true` if the frames are read back as half or single precision floats
+    const bool _isFloat;
     const bool _addAlpha;
+    const bool _usePersistentMapping;
+    const CaptureFormat _format;
+    /// The height of the bands in which frames are read, or 0 to read the full frame
+    const int _bandHeight;
+    /// The factor by which previews are smaller than the frames, or 1 for no previews
+    const int _previewFactor;
+    const int _previewInterval;
 
     const EyeIndex _eyeIndex;
+    const StereoLayout _stereoLayout;
     const Window& _window;
 };
 
@@ -0,0 +1,209 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__SHAREDFRAME__H__
+#define __SGCT__SHAREDFRAME__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/math.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace sgct {
+
+class Image;
+
+/**
+ * The layout of the POSIX shared memory object through which a SharedFrameSender
+ * publishes frames to other processes on the same machine. The object starts with a
+ * `Header`, followed by `NumberOfBuffers` buffers of `Header::bufferSize` bytes each.
+ * The sender writes every frame into the buffer after the newest one and then marks the
+ * new buffer as the newest, so a reader that copies the newest frame has two frames of
+ * time before the sender writes into the same buffer again. Each `Slot` is a seqlock:
+ * its sequence number is odd while the sender writes the buffer, and a reader that sees
+ * a different sequence number after copying the frame has read a torn frame and tries
+ * again. The sender never waits for readers.
+ */
+namespace sharedframe {
+    constexpr int NumberOfBuffers = 3;
+
+    /// The value of `Header::latest` before the first frame has been sent
+    constexpr uint32_t NoFrame = 0xFFFFFFFF;
+
+    struct alignas(64) Slot {
+        /// Odd while the sender writes the frame into the buffer
+        std::atomic<uint64_t> sequence = 0;
+        uint64_t frameNumber = 0;
+        /// The time in seconds of the steady clock when the frame was sent, which can be
+        /// compared between processes
+        double timestamp = 0.0;
+        /// The location of the buffer in bytes from the beginning of the object
+        uint64_t offset = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+        uint8_t nChannels = 0;
+        uint8_t bytesPerChannel = 0;
+        uint8_t isFloat = 0;
+    };
+
+    struct alignas(64) Header {
+        char magic[8] = { 'S', 'G', 'C', 'T', 'S', 'H', 'M', '1' };
+        /// The size of the whole object in bytes
+        uint64_t size = 0;
+        /// The capacity of each of the buffers in bytes
+        uint64_t bufferSize = 0;
+        /// The index of the slot with the newest frame or `NoFrame`
+        std::atomic<uint32_t> latest = NoFrame;
+        /// Set when the sender has closed or replaced the object, in which case readers
+        /// have to open the object with the same name again
+        std::atomic<uint32_t> isStale = 0;
+        Slot slots[NumberOfBuffers];
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+    static_assert(sizeof(Slot) == 64);
+    static_assert(sizeof(Header) == 256);
+} // namespace sharedframe
+
+/**
+ * Publishes frames through a POSIX shared memory object so that compositors, encoders, or
+ * other processes on the same machine receive them without a copy to disk. The object
+ * is created with the first frame and recreated if a frame does not fit into it. This
+ * is not supported on Windows, where Spout serves the same purpose.
+ */
+class SGCT_EXPORT SharedFrameSender {
+public:
+    /**
+     * Creates a sender that publishes its frames in the shared memory object with the
+     * \p name, for example `sgct-window0`. The object is created with the first frame.
+     */
+    explicit SharedFrameSender(std::string name);
+
+    /**
+     * Marks the object as stale and removes it.
+     */
+    ~SharedFrameSender();
+
+    SharedFrameSender(const SharedFrameSender&) = delete;
+    SharedFrameSender& operator=(const SharedFrameSender&) = delete;
+
+    /**
+     * Publishes the bottom-up BGR(A) pixel \p data of a frame with the \p size. The frame
+     * replaces the oldest of the buffers.
+     */
+    void send(const unsigned char* data, ivec2 size, int nChannels, int bytesPerChannel,
+        bool isFloat, uint64_t frameNumber);
+
+    const std::string& name() const;
+
+private:
+    /// Replaces the shared memory object with one whose buffers hold \p bufferSize bytes
+    void create(uint64_t bufferSize);
+    void destroy();
+
+    const std::string _name;
+    int _file = -1;
+    unsigned char* _mapping = nullptr;
+    uint64_t _size = 0;
+};
+
+/**
+ * Reads the frames of a window back from the GPU and publishes them through a
+ * SharedFrameSender. The readback uses two pixel buffers in turn, so a frame is published
+ * two frames after it was rendered and the rendering does not wait for the GPU. The
+ * publisher owns OpenGL objects, so it has to be used and destroyed while the OpenGL
+ * context in which it was used is current.
+ */
+class SGCT_EXPORT SharedFramePublisher {
+public:
+    /**
+     * Creates a publisher that sends its frames to the shared memory object with the
+     * \p name. Throws an Error on Windows.
+     */
+    explicit SharedFramePublisher(std::string name);
+
+    /**
+     * Deletes the pixel buffers and fences and removes the shared memory object.
+     */
+    ~SharedFramePublisher();
+
+    SharedFramePublisher(const SharedFramePublisher&) = delete;
+    SharedFramePublisher& operator=(const SharedFramePublisher&) = delete;
+
+    /**
+     * Publishes the frame that was read back two calls earlier and starts the readback
+     * of the BGRA \p texture with the \p size as the frame with the \p frameNumber.
+     */
+    void publish(unsigned int texture, ivec2 size, uint64_t frameNumber);
+
+private:
+    /// Deletes the pixel buffers and the fences of the readbacks that are in flight
+    void releaseBuffers();
+
+    SharedFrameSender _sender;
+    std::array<unsigned int, 2> _pbos = { 0, 0 };
+    /// The GLsync of the readback into each buffer, nullptr if none is in flight
+    std::array<void*, 2> _fences = { nullptr, nullptr };
+    std::array<uint64_t, 2> _frameNumbers = { 0, 0 };
+    ivec2 _size = ivec2{ 0, 0 };
+    int _next = 0;
+};
+
+/**
+ * Reads the frames that a SharedFrameSender in another process publishes. The reader
+ * never blocks the sender and only ever reads the newest frame, frames that were sent
+ * while the reader was busy are skipped.
+ */
+class SGCT_EXPORT SharedFrameReader {
+public:
+    /**
+     * Creates a reader for the shared memory object with the \p name. The sender does
+     * not have to be running yet, the object is opened when it becomes available.
+     */
+    explicit SharedFrameReader(std::string name);
+    ~SharedFrameReader();
+
+    SharedFrameReader(const SharedFrameReader&) = delete;
+    SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+
+    /**
+     * Copies the newest frame into the \p image if it is newer than the last frame that
+     * was read. Returns `false` if there is no new frame or no sender.
+     */
+    bool read(Image& image);
+
+    /**
+     * Returns the frame number of the last frame that was read.
+     */
+    uint64_t frameNumber() const;
+
+    /**
+     * Returns the time of the steady clock in seconds at which the last frame that was
+     * read was sent.
+     */
+    double timestamp() const;
+
+private:
+    bool open();
+    void close();
+
+    const std::string _name;
+    int _file = -1;
+    const unsigned char* _mapping = nullptr;
+    uint64_t _size = 0;
+    bool _hasFrame = false;
+    uint64_t _frameNumber = 0;
+    double _timestamp = 0.0;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__SHAREDFRAME__H__
@@ -0,0 +1,96 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__STATISTICSHISTORY__H__
+#define __SGCT__STATISTICSHISTORY__H__
+
+#include <sgct/sgctexports.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * The history of the last `HistoryLength` values of a timing. A value is added in
+ * constant time, and the average, minimum, and maximum are kept up to date while values
+ * are added, so they can be read every frame without going through the history. The
+ * percentiles are computed when they are requested.
+ */
+class SGCT_EXPORT StatisticsHistory {
+public:
+    static constexpr int HistoryLength = 512;
+
+    struct Percentiles {
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    };
+
+    /**
+     * Adds the \p value, which replaces the oldest value once the history is full.
+     */
+    void add(double value);
+
+    /**
+     * Returns the number of values in the history, which is at most `HistoryLength`.
+     */
+    int size() const;
+
+    /**
+     * Returns the value that was added last or 0 if the history is empty.
+     */
+    double newest() const;
+
+    /**
+     * Returns the average, minimum, and maximum of the values in the history, which are
+     * 0 if the history is empty.
+     */
+    double average() const;
+    double min() const;
+    double max() const;
+
+    /**
+     * Returns the 50th, 95th, and 99th percentile of the values in the history using the
+     * nearest rank. This sorts a copy of the history partially and should not be called
+     * more than once per frame.
+     */
+    Percentiles percentiles() const;
+
+    /**
+     * Returns the value that was added \p i values before the newest one, or 0 if there
+     * is no such value, so that the history can be read like an array with the newest
+     * value first.
+     */
+    double operator[](int i) const;
+
+private:
+    /// A queue of the sequence numbers of the values that can still become the minimum
+    /// or maximum of the history, with the current minimum or maximum first
+    struct ExtremaQueue {
+        std::array<uint64_t, HistoryLength> sequence = {};
+        int first = 0;
+        int count = 0;
+    };
+
+    template <typename Compare>
+    void push(ExtremaQueue& queue, uint64_t sequence, Compare compare);
+
+    std::array<double, HistoryLength> _values = {};
+    /// The number of values that were added in total
+    uint64_t _nValues = 0;
+    double _sum = 0.0;
+    ExtremaQueue _minimum;
+    ExtremaQueue _maximum;
+    mutable std::vector<double> _sorted;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__STATISTICSHISTORY__H__
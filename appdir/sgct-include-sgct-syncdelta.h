@@ -0,0 +1,136 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__SYNCDELTA__H__
+#define __SGCT__SYNCDELTA__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/statisticshistory.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * The format of the messages that a SyncDeltaEncoder creates. Each message starts with a
+ * `Header` that is followed by the payload. A keyframe carries the data of the frame,
+ * while a delta carries the data XOR-ed with the data of the base frame, which is mostly
+ * zeros if few of the synchronized values have changed. The payload is deflated unless
+ * that does not make it smaller.
+ */
+namespace syncdelta {
+    /// Set in `Header::flags` if the message is a keyframe
+    constexpr uint8_t Keyframe = 1;
+
+    /// Set in `Header::flags` if the payload is deflated
+    constexpr uint8_t Compressed = 2;
+
+    struct Header {
+        char magic[4] = { 'S', 'G', 'D', '2' };
+        uint8_t flags = 0;
+        uint8_t padding[3] = {};
+        /// Increases by one with every message
+        uint32_t sequence = 0;
+        /// The sequence number of the frame that a delta is relative to. For a keyframe
+        /// this is the sequence number of the message itself
+        uint32_t baseSequence = 0;
+        /// The size of the data of the frame in bytes
+        uint32_t size = 0;
+        /// The size of the payload that follows the header in bytes
+        uint32_t payloadSize = 0;
+    };
+    static_assert(sizeof(Header) == 24);
+} // namespace syncdelta
+
+/**
+ * Encodes the data that the master synchronizes to the clients every frame as the
+ * difference to the data of the last frame that all clients have acknowledged, which is
+ * reported with acknowledge, or of the last keyframe if that is newer. A keyframe is
+ * sent at a regular interval so that clients that missed a frame can continue.
+ */
+class SGCT_EXPORT SyncDeltaEncoder {
+public:
+    /**
+     * Creates an encoder that sends a keyframe every \p keyframeInterval frames.
+     */
+    explicit SyncDeltaEncoder(int keyframeInterval = 60);
+
+    /**
+     * Returns the message for the \p data of the next frame.
+     */
+    std::vector<std::byte> encode(const std::vector<std::byte>& data);
+
+    /**
+     * Marks the last frame that was encoded as received by all clients, so that the
+     * following frames are encoded relative to it. With the frame lock, this is the case
+     * at the beginning of a frame unless the master stopped waiting for the clients,
+     * which NetworkManager::isSyncComplete tells.
+     */
+    void acknowledge();
+
+    /**
+     * Makes the next message a keyframe.
+     */
+    void requestKeyframe();
+
+    /**
+     * Returns the histories of the size of the data and of the messages in bytes.
+     */
+    const StatisticsHistory& dataSizes() const;
+    const StatisticsHistory& messageSizes() const;
+
+private:
+    const int _keyframeInterval;
+    uint32_t _sequence = 0;
+    bool _isKeyframeRequested = true;
+    /// The last encoded frame, which is waiting to be acknowledged
+    std::vector<std::byte> _sent;
+    bool _hasSent = false;
+    /// The last acknowledged frame or keyframe, to which the deltas are relative
+    std::vector<std::byte> _base;
+    uint32_t _baseSequence = 0;
+    bool _hasBase = false;
+    std::vector<std::byte> _delta;
+    StatisticsHistory _dataSizes;
+    StatisticsHistory _messageSizes;
+};
+
+/**
+ * Restores the data of the frames from the messages of a SyncDeltaEncoder. The decoder
+ * keeps the last few frames, as the master might send several deltas relative to the
+ * same frame while it is waiting for the acknowledgements.
+ */
+class SGCT_EXPORT SyncDeltaDecoder {
+public:
+    /// The number of frames that are kept as the base for later deltas
+    static constexpr int MaxFrames = 8;
+
+    /**
+     * Restores the data of a frame from the \p message into \p data. Returns `false` if
+     * the message is a delta to a frame that this decoder did not receive or no longer
+     * has, in which case the frame cannot be restored before the next keyframe. Throws
+     * an Error if the message is invalid.
+     */
+    bool decode(const std::vector<std::byte>& message, std::vector<std::byte>& data);
+
+private:
+    struct Frame {
+        uint32_t sequence = 0;
+        std::vector<std::byte> data;
+    };
+    /// The last decoded frames, oldest first
+    std::deque<Frame> _frames;
+    std::vector<std::byte> _payload;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__SYNCDELTA__H__
@@ -0,0 +1,104 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__VIDEOSTREAM__H__
+#define __SGCT__VIDEOSTREAM__H__
+
+#include <sgct/sgctexports.h>
+
+#include <sgct/math.h>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sgct {
+
+class Image;
+
+/**
+ * Writes captured frames as an uncompressed video stream into a file or into the standard
+ * input of another process, for example a video encoder. The frames can be converted and
+ * submitted from multiple threads, but are always written in the order in which their
+ * positions in the stream were reserved. The stream has to be owned by a `shared_ptr`.
+ */
+class SGCT_EXPORT VideoStream : public std::enable_shared_from_this<VideoStream> {
+public:
+    enum class Format {
+        /// YUV4MPEG2 with 4:2:0 chroma subsampling and BT.601 limited range colors
+        Y4M,
+        /// Headerless, top-down 8-bit RGB pixel data
+        RawRGB
+    };
+
+    /**
+     * Opens the \p destination for a stream of frames with the size \p size. If the
+     * \p destination starts with `|`, the rest of it is executed as a command that
+     * receives the stream on its standard input. Otherwise it is the path of the file
+     * that is created. The \p frameRate is only stored in the Y4M header.
+     */
+    VideoStream(std::string destination, Format format, ivec2 size, int frameRate);
+
+    /**
+     * Closes the stream. As every reserved frame keeps the stream alive, all frames have
+     * been written or skipped at this point. For a command, this waits until the process
+     * has exited.
+     */
+    ~VideoStream();
+
+    VideoStream(const VideoStream&) = delete;
+    VideoStream& operator=(const VideoStream&) = delete;
+
+    /**
+     * Reserves the position of the next frame in the stream. The frame for it has to be
+     * passed to `submit` before the returned ticket is released; if the ticket is
+     * released without a frame, that position is skipped so that later frames are not
+     * held back.
+     */
+    std::shared_ptr<const uint64_t> reserveFrame();
+
+    /**
+     * Converts the 8-bit, bottom-up BGR(A) \p image into a single frame of this stream.
+     * This can be called from any thread.
+     */
+    std::vector<unsigned char> encode(const Image& image) const;
+
+    /**
+     * Writes the encoded \p frame at the \p position, or stores it until all previous
+     * positions have been written or skipped. This can be called from any thread.
+     */
+    void submit(uint64_t position, std::vector<unsigned char> frame);
+
+private:
+    void skip(uint64_t position);
+
+    /// Writes the pending frames that are next in line. Requires the `_mutex` lock
+    void writePending(std::unique_lock<std::mutex>& lock);
+    void write(const unsigned char* data, size_t size);
+
+    const std::string _destination;
+    const Format _format;
+    const ivec2 _size;
+    const bool _isPipe;
+    std::FILE* _file = nullptr;
+
+    std::mutex _mutex;
+    /// Encoded frames that wait for an earlier frame. An empty frame is skipped
+    std::map<uint64_t, std::vector<unsigned char>> _pending;
+    uint64_t _nextReserved = 0;
+    uint64_t _nextWritten = 0;
+    bool _isWriting = false;
+    bool _hasFailed = false;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__VIDEOSTREAM__H__
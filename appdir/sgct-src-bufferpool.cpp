@@ -0,0 +1,240 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/bufferpool.h>
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <utility>
+
+#ifdef WIN32
+#include <malloc.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif // WIN32
+
+#define Err(code, msg) Error(Error::Component::Image, code, msg)
+
+namespace sgct {
+
+namespace {
+    constexpr size_t Alignment = 64;
+    constexpr size_t HugePageSize = 2 * 1024 * 1024;
+    constexpr size_t PageSize = 4096;
+
+#ifdef __linux__
+    constexpr bool SupportsHugePages = true;
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    constexpr bool SupportsHugePages = false;
+#endif // __linux__
+
+    double now() {
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+} // namespace
+
+BufferPool& BufferPool::instance() {
+    // The pool is never destroyed so that images which are destroyed during the static
+    // destruction can still give back their memory
+    static BufferPool* Instance = new BufferPool;
+    return *Instance;
+}
+
+void BufferPool::setSettings(Settings settings) {
+    const std::unique_lock lock(_mutex);
+    _settings = std::move(settings);
+}
+
+BufferPool::Settings BufferPool::settings() const {
+    const std::unique_lock lock(_mutex);
+    return _settings;
+}
+
+unsigned char* BufferPool::acquire(size_t size) {
+    ZoneScoped;
+
+    Allocation allocation;
+    bool prefault = false;
+    std::vector<unsigned char*> expired;
+    {
+        const std::unique_lock lock(_mutex);
+        allocation.size = bucketSize(size);
+        auto it = _cached.find(allocation.size);
+        if (it != _cached.end() && !it->second.empty()) {
+            unsigned char* buffer = it->second.back().buffer;
+            it->second.pop_back();
+            _statistics.nHits++;
+            _statistics.nBytesCached -= allocation.size;
+            _statistics.nBytesInUse += allocation.size;
+            return buffer;
+        }
+        _statistics.nMisses++;
+        allocation.usesHugePages = SupportsHugePages && _settings.useHugePages &&
+            allocation.size % HugePageSize == 0;
+        prefault = _settings.prefault;
+        collectExpired(now(), expired);
+    }
+    // Buffers that were idle for too long are freed first, so that their memory can be
+    // reused for the new buffer
+    for (unsigned char* buffer : expired) {
+        deallocate(buffer);
+    }
+
+    // The allocation is done without holding the lock as touching all pages of a large
+    // buffer takes a while
+    unsigned char* buffer = allocate(allocation);
+    if (!buffer) {
+        throw Err(9036, std::format("Failed to allocate {} bytes", allocation.size));
+    }
+    if (prefault) {
+        for (size_t i = 0; i < allocation.size; i += PageSize) {
+            buffer[i] = 0;
+        }
+    }
+    Log::Debug(std::format("Allocated buffer with {} bytes", allocation.size));
+
+    const std::unique_lock lock(_mutex);
+    _allocations.emplace(buffer, allocation);
+    _statistics.nBytesInUse += allocation.size;
+    return buffer;
+}
+
+void BufferPool::release(unsigned char* buffer) {
+    if (!buffer) {
+        return;
+    }
+
+    std::vector<unsigned char*> expired;
+    {
+        const std::unique_lock lock(_mutex);
+        auto it = _allocations.find(buffer);
+        if (it == _allocations.end()) {
+            Log::Error("Released a buffer that does not belong to the buffer pool");
+            return;
+        }
+        const Allocation allocation = it->second;
+        _statistics.nBytesInUse -= allocation.size;
+        const double t = now();
+        collectExpired(t, expired);
+        if (_statistics.nBytesCached + allocation.size <= _settings.maxCachedBytes) {
+            _cached[allocation.size].push_back({ buffer, t });
+            _statistics.nBytesCached += allocation.size;
+        }
+        else {
+            _allocations.erase(it);
+            expired.push_back(buffer);
+        }
+    }
+
+    for (unsigned char* b : expired) {
+        deallocate(b);
+    }
+}
+
+void BufferPool::clear() {
+    std::vector<unsigned char*> buffers;
+    {
+        const std::unique_lock lock(_mutex);
+        for (const auto& [size, cached] : _cached) {
+            for (const CachedBuffer& c : cached) {
+                _allocations.erase(c.buffer);
+                buffers.push_back(c.buffer);
+            }
+        }
+        _cached.clear();
+        _statistics.nBytesCached = 0;
+    }
+
+    for (unsigned char* buffer : buffers) {
+        deallocate(buffer);
+    }
+}
+
+void BufferPool::trim() {
+    std::vector<unsigned char*> expired;
+    {
+        const std::unique_lock lock(_mutex);
+        collectExpired(now(), expired);
+    }
+
+    for (unsigned char* buffer : expired) {
+        deallocate(buffer);
+    }
+}
+
+BufferPool::Statistics BufferPool::statistics() const {
+    const std::unique_lock lock(_mutex);
+    return _statistics;
+}
+
+size_t BufferPool::bucketSize(size_t size) const {
+    // Sizes are rounded up to one of four steps between two powers of two, so that at
+    // most a quarter of a buffer is unused, while sizes that differ by a few rows still
+    // end up in the same bucket
+    size = std::max(size, Alignment);
+    const int exponent = std::bit_width(size - 1) - 1;
+    const size_t step = std::max(Alignment, (size_t(1) << exponent) / 4);
+    size_t bucket = (size + step - 1) / step * step;
+    if (SupportsHugePages && _settings.useHugePages && bucket >= HugePageSize) {
+        bucket = (bucket + HugePageSize - 1) / HugePageSize * HugePageSize;
+    }
+    return bucket;
+}
+
+void BufferPool::collectExpired(double now, std::vector<unsigned char*>& expired) {
+    for (auto& [size, cached] : _cached) {
+        const auto end = std::remove_if(
+            cached.begin(),
+            cached.end(),
+            [&](const CachedBuffer& c) {
+                if (now - c.releaseTime <= _settings.maxIdleTime) {
+                    return false;
+                }
+                _allocations.erase(c.buffer);
+                expired.push_back(c.buffer);
+                _statistics.nBytesCached -= size;
+                return true;
+            }
+        );
+        cached.erase(end, cached.end());
+    }
+}
+
+unsigned char* BufferPool::allocate(const Allocation& allocation) {
+#ifdef WIN32
+    return static_cast<unsigned char*>(_aligned_malloc(allocation.size, Alignment));
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    const size_t alignment = allocation.usesHugePages ? HugePageSize : Alignment;
+    void* buffer = std::aligned_alloc(alignment, allocation.size);
+#ifdef __linux__
+    if (buffer && allocation.usesHugePages) {
+        // This is only a hint, if transparent huge pages are disabled the buffer still
+        // uses regular pages
+        madvise(buffer, allocation.size, MADV_HUGEPAGE);
+    }
+#endif // __linux__
+    return static_cast<unsigned char*>(buffer);
+#endif // WIN32
+}
+
+void BufferPool::deallocate(unsigned char* buffer) {
+#ifdef WIN32
+    _aligned_free(buffer);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    std::free(buffer);
+#endif // WIN32
+}
+
+} // namespace sgct
@@ -0,0 +1,380 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/capturecontainer.h>
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/image.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef WIN32
+#include <Windows.h>
+#else // ^^^^ WIN32 // !WIN32 vvvv
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+#define Err(code, msg) Error(Error::Component::Image, code, msg)
+
+namespace sgct {
+
+using namespace capturecontainer;
+
+namespace {
+    // The frames start at the first page after the header
+    constexpr uint64_t DataStart = 4096;
+
+    // Each frame is preceded by its entry, padded so that the frame data is aligned
+    constexpr uint64_t Alignment = 64;
+    constexpr uint64_t EntrySize = Alignment;
+    static_assert(sizeof(Entry) <= EntrySize);
+
+    uint64_t alignUp(uint64_t v) {
+        return (v + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    bool isValidEntry(const Entry& e, uint64_t position, uint64_t fileSize) {
+        return e.offset == position + EntrySize && e.size > 0 &&
+            e.size <= fileSize - e.offset && e.nChannels > 0 && e.bytesPerChannel > 0;
+    }
+} // namespace
+
+CaptureContainerWriter::CaptureContainerWriter(std::filesystem::path path,
+                                               uint64_t initialSize)
+    : _path(std::move(path))
+    , _end(DataStart)
+{
+    ZoneScoped;
+
+    const std::string p = _path.string();
+#ifdef WIN32
+    _file = CreateFileA(
+        p.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ,
+        nullptr,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        throw Err(9020, std::format("Cannot create capture container '{}'", p));
+    }
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    _file = open(p.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (_file == -1) {
+        throw Err(9020, std::format("Cannot create capture container '{}'", p));
+    }
+#endif // WIN32
+
+    const std::unique_lock lock(_mappingMutex);
+    grow(std::max(initialSize, DataStart));
+
+    Header header;
+    std::memcpy(_mapping, &header, sizeof(Header));
+    Log::Info(std::format("Writing captured frames to container '{}'", p));
+}
+
+CaptureContainerWriter::~CaptureContainerWriter() {
+    ZoneScoped;
+
+    const std::unique_lock lock(_mappingMutex);
+
+    // Frames that could not be written after their region was reserved have no data
+    std::erase_if(_entries, [](const Entry& e) { return e.size == 0; });
+
+    // The index is placed after the last frame
+    Header header;
+    header.dataEnd = _end;
+    header.indexOffset = alignUp(_end);
+    header.nEntries = _entries.size();
+    const uint64_t indexSize = _entries.size() * sizeof(Entry);
+    const uint64_t fileSize = header.indexOffset + indexSize;
+    try {
+        grow(fileSize);
+        if (indexSize > 0) {
+            std::memcpy(_mapping + header.indexOffset, _entries.data(), indexSize);
+        }
+        std::memcpy(_mapping, &header, sizeof(Header));
+    }
+    catch (const std::runtime_error& e) {
+        // If the index could not be written, the frames can still be recovered
+        Log::Error(e.what());
+    }
+
+#ifdef WIN32
+    if (_mapping) {
+        FlushViewOfFile(_mapping, 0);
+        UnmapViewOfFile(_mapping);
+    }
+    if (_fileMapping) {
+        CloseHandle(_fileMapping);
+    }
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(fileSize);
+    SetFilePointerEx(_file, size, nullptr, FILE_BEGIN);
+    SetEndOfFile(_file);
+    CloseHandle(_file);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    if (_mapping) {
+        munmap(_mapping, _capacity);
+    }
+    if (ftruncate(_file, static_cast<off_t>(fileSize)) != 0) {
+        Log::Error(std::format("Error truncating capture container '{}'", _path));
+    }
+    close(_file);
+#endif // WIN32
+
+    Log::Info(std::format(
+        "Closed capture container '{}' with {} frames", _path, _entries.size()
+    ));
+}
+
+void CaptureContainerWriter::append(Entry entry, const unsigned char* data,
+                                    uint64_t size)
+{
+    ZoneScoped;
+
+    uint64_t position = 0;
+    size_t index = 0;
+    {
+        // Reserve the region for this frame. The file is grown first so that nothing is
+        // reserved if it cannot be grown
+        const std::unique_lock lock(_mutex);
+        position = _end;
+        const uint64_t end = alignUp(position + EntrySize + size);
+        if (end > _capacity) {
+            // Wait for all other appends to finish copying before remapping the file
+            const std::unique_lock mappingLock(_mappingMutex);
+            grow(std::max(end, _capacity * 2));
+        }
+
+        _end = end;
+        entry.offset = position + EntrySize;
+        entry.size = size;
+        index = _entries.size();
+        _entries.push_back(entry);
+    }
+
+    {
+        const std::shared_lock mappingLock(_mappingMutex);
+        if (_mapping) {
+            std::memcpy(_mapping + entry.offset, data, size);
+            std::memcpy(_mapping + position, &entry, sizeof(Entry));
+            return;
+        }
+    }
+
+    // Growing the file failed for another frame after the region was reserved, so this
+    // frame is left out of the index. The mapping lock must be released before locking
+    // the reservations, which are locked first while growing the file
+    {
+        const std::unique_lock lock(_mutex);
+        _entries[index].size = 0;
+    }
+    throw Err(
+        9026,
+        std::format(
+            "Cannot write frame {} to capture container '{}'", entry.frameNumber, _path
+        )
+    );
+}
+
+const std::filesystem::path& CaptureContainerWriter::path() const {
+    return _path;
+}
+
+void CaptureContainerWriter::grow(uint64_t size) {
+    if (size <= _capacity) {
+        return;
+    }
+    Log::Debug(std::format("Growing capture container '{}' to {} bytes", _path, size));
+
+#ifdef WIN32
+    if (_mapping) {
+        UnmapViewOfFile(_mapping);
+        _mapping = nullptr;
+    }
+    if (_fileMapping) {
+        CloseHandle(_fileMapping);
+        _fileMapping = nullptr;
+    }
+    _fileMapping = CreateFileMappingA(
+        _file,
+        nullptr,
+        PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32),
+        static_cast<DWORD>(size & 0xFFFFFFFF),
+        nullptr
+    );
+    if (_fileMapping) {
+        _mapping = reinterpret_cast<unsigned char*>(
+            MapViewOfFile(_fileMapping, FILE_MAP_WRITE, 0, 0, 0)
+        );
+    }
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    if (_mapping) {
+        munmap(_mapping, _capacity);
+        _mapping = nullptr;
+    }
+#ifdef __linux__
+    // Reserve the blocks on disk up front so that writing the frames does not have to
+    // allocate them
+    const int res = posix_fallocate(_file, 0, static_cast<off_t>(size));
+#else // ^^^^ __linux__ // !__linux__ vvvv
+    const int res = ftruncate(_file, static_cast<off_t>(size));
+#endif // __linux__
+    if (res == 0) {
+        void* m = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+        if (m != MAP_FAILED) {
+            _mapping = reinterpret_cast<unsigned char*>(m);
+#ifdef __linux__
+            madvise(_mapping, size, MADV_SEQUENTIAL);
+#endif // __linux__
+        }
+    }
+#endif // WIN32
+
+    if (!_mapping) {
+        _capacity = 0;
+        throw Err(
+            9021,
+            std::format("Cannot map {} bytes of capture container '{}'", size, _path)
+        );
+    }
+    _capacity = size;
+}
+
+CaptureContainerReader::CaptureContainerReader(const std::filesystem::path& path) {
+    ZoneScoped;
+
+    const std::string p = path.string();
+    _size = std::filesystem::file_size(path);
+    if (_size < DataStart) {
+        throw Err(9022, std::format("Invalid capture container '{}'", p));
+    }
+
+#ifdef WIN32
+    _file = CreateFileA(
+        p.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        throw Err(9023, std::format("Cannot open capture container '{}'", p));
+    }
+    _fileMapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_fileMapping) {
+        _data = reinterpret_cast<const unsigned char*>(
+            MapViewOfFile(_fileMapping, FILE_MAP_READ, 0, 0, 0)
+        );
+    }
+    if (!_data) {
+        if (_fileMapping) {
+            CloseHandle(_fileMapping);
+        }
+        CloseHandle(_file);
+        throw Err(9023, std::format("Cannot open capture container '{}'", p));
+    }
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    const int file = open(p.c_str(), O_RDONLY);
+    if (file == -1) {
+        throw Err(9023, std::format("Cannot open capture container '{}'", p));
+    }
+    void* m = mmap(nullptr, _size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (m == MAP_FAILED) {
+        throw Err(9023, std::format("Cannot open capture container '{}'", p));
+    }
+    _data = reinterpret_cast<const unsigned char*>(m);
+#endif // WIN32
+
+    Header header;
+    std::memcpy(&header, _data, sizeof(Header));
+    if (std::memcmp(header.magic, Header().magic, sizeof(Header::magic)) != 0) {
+        throw Err(9022, std::format("Invalid capture container '{}'", p));
+    }
+
+    const uint64_t indexSize = header.nEntries * sizeof(Entry);
+    if (header.indexOffset != 0 && header.indexOffset + indexSize <= _size) {
+        _entries.resize(header.nEntries);
+        std::memcpy(_entries.data(), _data + header.indexOffset, indexSize);
+    }
+    else {
+        // The container was not closed, so we recover the frames from the entries that
+        // precede them until we reach the preallocated but unused part of the file
+        Log::Warning(std::format("Recovering frames of unfinished container '{}'", p));
+        uint64_t position = DataStart;
+        while (position + EntrySize <= _size) {
+            Entry e;
+            std::memcpy(&e, _data + position, sizeof(Entry));
+            if (!isValidEntry(e, position, _size)) {
+                break;
+            }
+            _entries.push_back(e);
+            position = alignUp(e.offset + e.size);
+        }
+    }
+    Log::Debug(std::format("Opened container '{}' with {} frames", p, _entries.size()));
+}
+
+CaptureContainerReader::~CaptureContainerReader() {
+#ifdef WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_fileMapping);
+    CloseHandle(_file);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    munmap(const_cast<unsigned char*>(_data), _size);
+#endif // WIN32
+}
+
+const std::vector<Entry>& CaptureContainerReader::entries() const {
+    return _entries;
+}
+
+const unsigned char* CaptureContainerReader::data(const Entry& entry) const {
+    if (entry.offset + entry.size > _size) {
+        throw Err(9024, "Frame is outside of the capture container");
+    }
+    return _data + entry.offset;
+}
+
+void CaptureContainerReader::read(const Entry& entry, Image& image) const {
+    const unsigned char* d = data(entry);
+    switch (entry.codec) {
+        case Codec::Raw:
+        case Codec::RawFloat:
+            image.setSize(ivec2{ entry.width, entry.height });
+            image.setChannels(entry.nChannels);
+            image.setBytesPerChannel(entry.bytesPerChannel);
+            image.setFloatingPoint(entry.codec == Codec::RawFloat);
+            image.allocateOrResizeData();
+            std::memcpy(image.data(), d, entry.size);
+            break;
+        case Codec::QOI:
+            image.load(const_cast<unsigned char*>(d), static_cast<int>(entry.size));
+            break;
+        default:
+            throw Err(9025, "Unknown codec in capture container");
+    }
+}
+
+} // namespace sgct
@@ -0,0 +1,212 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/capturepool.h>
+
+#include <sgct/format.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace sgct {
+
+CapturePool::CapturePool(unsigned int nThreads, size_t queueLength,
+                         OverflowPolicy policy)
+    : _queueLength(std::max<size_t>(queueLength, 1))
+    , _policy(policy)
+{
+    nThreads = std::max(nThreads, 1u);
+    _workers.reserve(nThreads);
+    for (unsigned int i = 0; i < nThreads; i++) {
+        _workers.emplace_back(&CapturePool::worker, this);
+    }
+    Log::Debug(std::format(
+        "Started capture pool with {} threads and queue length {}",
+        nThreads, _queueLength
+    ));
+}
+
+CapturePool::~CapturePool() {
+    {
+        const std::unique_lock lock(_mutex);
+        _shouldStop = true;
+    }
+    _jobAdded.notify_all();
+    _jobFinished.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+bool CapturePool::enqueue(Job job) {
+    // The discarded job is destroyed after the lock is released as its destructor might
+    // release resources that are guarded by other mutexes
+    Job discarded;
+    {
+        std::unique_lock lock(_mutex);
+        if (_queue.size() >= _queueLength) {
+            switch (_policy) {
+                case OverflowPolicy::Block:
+                    _jobFinished.wait(
+                        lock,
+                        [this]() { return _queue.size() < _queueLength || _shouldStop; }
+                    );
+                    break;
+                case OverflowPolicy::DropOldest:
+                    discarded = std::move(_queue.front());
+                    _queue.pop_front();
+                    _nDroppedJobs++;
+                    break;
+                case OverflowPolicy::DropNewest:
+                    _nDroppedJobs++;
+                    return false;
+                default:
+                    throw std::logic_error("Unhandled case label");
+            }
+        }
+        _queue.push_back(std::move(job));
+    }
+    _jobAdded.notify_one();
+    return true;
+}
+
+void CapturePool::runInParallel(int n, const std::function<void(int)>& task) {
+    ZoneScoped;
+
+    // The state is shared with the helper jobs, which might only start after this call
+    // has returned. They do not touch the task anymore at that point as all indices
+    // have been taken
+    struct State {
+        const std::function<void(int)>* task = nullptr;
+        int n = 0;
+        std::atomic_int next = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+        int nFinished = 0;
+        std::exception_ptr exception;
+    };
+    auto state = std::make_shared<State>();
+    state->task = &task;
+    state->n = n;
+
+    auto run = [](State& s) {
+        for (int i = s.next++; i < s.n; i = s.next++) {
+            std::exception_ptr exception;
+            try {
+                (*s.task)(i);
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+
+            const std::unique_lock lock(s.mutex);
+            if (exception && !s.exception) {
+                s.exception = exception;
+            }
+            s.nFinished++;
+            if (s.nFinished == s.n) {
+                s.finished.notify_all();
+            }
+        }
+    };
+
+    const int nHelpers = std::min(n - 1, static_cast<int>(_workers.size()));
+    if (nHelpers > 0) {
+        {
+            const std::unique_lock lock(_mutex);
+            for (int i = 0; i < nHelpers; i++) {
+                _helperJobs.emplace_back([state, run]() { run(*state); });
+            }
+        }
+        _jobAdded.notify_all();
+    }
+
+    run(*state);
+    std::unique_lock lock(state->mutex);
+    state->finished.wait(lock, [&s = *state]() { return s.nFinished >= s.n; });
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+void CapturePool::setOverflowPolicy(OverflowPolicy policy) {
+    const std::unique_lock lock(_mutex);
+    _policy = policy;
+}
+
+void CapturePool::waitForIdle() {
+    std::unique_lock lock(_mutex);
+    _jobFinished.wait(lock, [this]() { return _queue.empty() && _nActiveJobs == 0; });
+}
+
+size_t CapturePool::queueDepth() const {
+    const std::unique_lock lock(_mutex);
+    return _queue.size();
+}
+
+uint64_t CapturePool::nDroppedJobs() const {
+    const std::unique_lock lock(_mutex);
+    return _nDroppedJobs;
+}
+
+void CapturePool::worker() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(_mutex);
+            _jobAdded.wait(
+                lock,
+                [this]() {
+                    return !_queue.empty() || !_helperJobs.empty() || _shouldStop;
+                }
+            );
+
+            // When stopping, the remaining jobs are still processed so that no captured
+            // frame is lost
+            if (!_helperJobs.empty()) {
+                job = std::move(_helperJobs.front());
+                _helperJobs.pop_front();
+            }
+            else if (!_queue.empty()) {
+                job = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            else {
+                return;
+            }
+            _nActiveJobs++;
+        }
+        // Waking the producer as soon as there is room in the queue
+        _jobFinished.notify_all();
+
+        {
+            ZoneScopedN("Capture job");
+            try {
+                job();
+            }
+            catch (const std::exception& e) {
+                Log::Error(e.what());
+            }
+            job = nullptr;
+        }
+
+        {
+            const std::unique_lock lock(_mutex);
+            _nActiveJobs--;
+        }
+        _jobFinished.notify_all();
+    }
+}
+
+} // namespace sgct
@@ -0,0 +1,213 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/capturestatisticsrenderer.h>
+
+#include <sgct/opengl.h>
+#include <sgct/profiling.h>
+#include <sgct/screencapture.h>
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace sgct {
+
+namespace {
+    // The values that fill the height of the graph, as in the frame time graph
+    constexpr float MaxTime = 1.f / 30.f;
+
+    // The size of the graph in pixels with a scale of 1
+    constexpr float GraphWidth = 512.f;
+    constexpr float GraphHeight = 250.f;
+
+    constexpr vec4 ColorBackground = vec4{ 0.f, 0.f, 0.f, 0.5f };
+    constexpr vec4 ColorFrequency = vec4{ 1.f, 1.f, 1.f, 0.5f };
+    constexpr vec4 ColorQueueDepth = vec4{ 0.8f, 0.8f, 0.15f, 0.8f };
+    constexpr vec4 ColorReadbackWait = vec4{ 0.8f, 0.15f, 0.15f, 0.8f };
+    constexpr vec4 ColorEncode = vec4{ 0.15f, 0.8f, 0.15f, 0.8f };
+    constexpr vec4 ColorWrite = vec4{ 0.15f, 0.15f, 0.8f, 0.8f };
+    constexpr vec4 ColorDropped = vec4{ 0.8f, 0.15f, 0.8f, 0.8f };
+
+    constexpr std::string_view VertShader = R"(
+#version 460 core
+
+layout (location = 0) in vec2 in_vertPosition;
+
+uniform mat4 mvp;
+
+
+void main() { gl_Position = mvp * vec4(in_vertPosition, 0.0, 1.0); }
+)";
+
+    constexpr std::string_view FragShader = R"(
+#version 460 core
+
+out vec4 out_color;
+
+uniform vec4 col;
+
+
+void main() { out_color = col; }
+)";
+
+    void setupVertexArray(unsigned int& vao, unsigned int vbo, int stride) {
+        glCreateVertexArrays(1, &vao);
+        glVertexArrayVertexBuffer(vao, 0, vbo, 0, stride);
+        glEnableVertexArrayAttrib(vao, 0);
+        glVertexArrayAttribFormat(vao, 0, 2, GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribBinding(vao, 0, 0);
+    }
+} // namespace
+
+CaptureStatisticsRenderer::CaptureStatisticsRenderer(
+                                                  const Engine::Statistics& statistics)
+    : _statistics(statistics)
+{
+    ZoneScoped;
+
+    _shader = ShaderProgram("Capture Statistics Shader");
+    _shader.addVertexShader(VertShader);
+    _shader.addFragmentShader(FragShader);
+    _shader.createAndLinkProgram();
+    _mvpLoc = glGetUniformLocation(_shader.id(), "mvp");
+    _colorLoc = glGetUniformLocation(_shader.id(), "col");
+
+    constexpr float L = static_cast<float>(Length);
+    const std::vector<Vertex> vs = {
+        // Background quad
+        { 0.f, 0.f }, { L, 0.f }, { 0.f, MaxTime }, { L, MaxTime },
+        // 0, 60 Hz, and 30 Hz lines
+        { 0.f, 0.f }, { L, 0.f },
+        { 0.f, 1.f / 60.f }, { L, 1.f / 60.f },
+        { 0.f, MaxTime }, { L, MaxTime }
+    };
+    glCreateBuffers(1, &_staticVbo);
+    glNamedBufferStorage(_staticVbo, vs.size() * sizeof(Vertex), vs.data(), 0);
+    setupVertexArray(_staticVao, _staticVbo, sizeof(Vertex));
+
+    for (int i = 0; i < NSeries * Length; i++) {
+        _vertices[i] = Vertex{ static_cast<float>(i % Length), 0.f };
+    }
+    glCreateBuffers(1, &_dynamicVbo);
+    glNamedBufferStorage(
+        _dynamicVbo,
+        sizeof(_vertices),
+        _vertices.data(),
+        GL_DYNAMIC_STORAGE_BIT
+    );
+    setupVertexArray(_dynamicVao, _dynamicVbo, sizeof(Vertex));
+}
+
+CaptureStatisticsRenderer::~CaptureStatisticsRenderer() {
+    glDeleteVertexArrays(1, &_staticVao);
+    glDeleteBuffers(1, &_staticVbo);
+    glDeleteVertexArrays(1, &_dynamicVao);
+    glDeleteBuffers(1, &_dynamicVbo);
+}
+
+void CaptureStatisticsRenderer::update() {
+    ZoneScoped;
+
+    // Copies the history into the line strip of the series with the newest value first,
+    // like the frame time graph
+    auto copy = [this](const StatisticsHistory& history, Series series, float factor) {
+        Vertex* v = _vertices.data() + series * Length;
+        for (int i = 0; i < Length; i++) {
+            v[i].y = static_cast<float>(history[i]) * factor;
+        }
+    };
+    const int queueLength = std::max(ScreenCapture::settings().queueLength, 1);
+    copy(_statistics.captureQueueDepth, QueueDepth, MaxTime / queueLength);
+    copy(_statistics.captureReadbackWaitTimes, ReadbackWait, 1.f);
+    copy(_statistics.captureEncodeTimes, Encode, 1.f);
+    copy(_statistics.captureWriteTimes, Write, 1.f);
+
+    // The history contains the total number of dropped frames, which only increases
+    const StatisticsHistory& total = _statistics.droppedCaptureFrames;
+    Vertex* dropped = _vertices.data() + Dropped * Length;
+    for (int i = 0; i < Length - 1; i++) {
+        dropped[i].y = total[i] > total[i + 1] ? MaxTime : 0.f;
+    }
+    dropped[Length - 1].y = 0.f;
+
+    glNamedBufferSubData(_dynamicVbo, 0, sizeof(_vertices), _vertices.data());
+}
+
+void CaptureStatisticsRenderer::render() const {
+    ZoneScoped;
+
+    std::array<int, 4> viewport = {};
+    glGetIntegerv(GL_VIEWPORT, viewport.data());
+    const float width = static_cast<float>(viewport[2]);
+    const float height = static_cast<float>(viewport[3]);
+    if (width <= 0.f || height <= 0.f) {
+        return;
+    }
+
+    // Maps the graph coordinates, the index of the value and the value in seconds, to
+    // the top right corner of the viewport
+    const float sizeX = GraphWidth * _scale;
+    const float sizeY = GraphHeight * _scale;
+    const float x = width - sizeX + _offset.x * width;
+    const float y = height - sizeY + _offset.y * height;
+    const std::array<float, 16> mvp = {
+        2.f * sizeX / (Length * width), 0.f, 0.f, 0.f,
+        0.f, 2.f * sizeY / (MaxTime * height), 0.f, 0.f,
+        0.f, 0.f, 1.f, 0.f,
+        2.f * x / width - 1.f, 2.f * y / height - 1.f, 0.f, 1.f
+    };
+
+    const bool isBlendEnabled = glIsEnabled(GL_BLEND);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    _shader.bind();
+    glProgramUniformMatrix4fv(_shader.id(), _mvpLoc, 1, GL_FALSE, mvp.data());
+
+    glBindVertexArray(_staticVao);
+    glProgramUniform4fv(_shader.id(), _colorLoc, 1, &ColorBackground.x);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glProgramUniform4fv(_shader.id(), _colorLoc, 1, &ColorFrequency.x);
+    glDrawArrays(GL_LINES, 4, 6);
+
+    glBindVertexArray(_dynamicVao);
+    glProgramUniform4fv(_shader.id(), _colorLoc, 1, &ColorQueueDepth.x);
+    glDrawArrays(GL_LINE_STRIP, QueueDepth * Length, Length);
+    glProgramUniform4fv(_shader.id(), _colorLoc, 1, &ColorReadbackWait.x);
+    glDrawArrays(GL_LINE_STRIP, ReadbackWait * Length, Length);
+    glProgramUniform4fv(_shader.id(), _colorLoc, 1, &ColorEncode.x);
+    glDrawArrays(GL_LINE_STRIP, Encode * Length, Length);
+    glProgramUniform4fv(_shader.id(), _colorLoc, 1, &ColorWrite.x);
+    glDrawArrays(GL_LINE_STRIP, Write * Length, Length);
+    glProgramUniform4fv(_shader.id(), _colorLoc, 1, &ColorDropped.x);
+    glDrawArrays(GL_LINE_STRIP, Dropped * Length, Length);
+
+    glBindVertexArray(0);
+    ShaderProgram::unbind();
+    if (!isBlendEnabled) {
+        glDisable(GL_BLEND);
+    }
+}
+
+float CaptureStatisticsRenderer::scale() const {
+    return _scale;
+}
+
+void CaptureStatisticsRenderer::setScale(float scale) {
+    _scale = scale;
+}
+
+vec2 CaptureStatisticsRenderer::offset() const {
+    return _offset;
+}
+
+void CaptureStatisticsRenderer::setOffset(vec2 offset) {
+    _offset = offset;
+}
+
+} // namespace sgct
@@ -0,0 +1,598 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/capturewriter.h>
+
+#include <sgct/format.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif // WIN32
+
+// The io_uring is used through the raw system calls, so only the kernel headers are
+// needed and not liburing
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define SGCT_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif // defined(__linux__) && __has_include(<linux/io_uring.h>)
+
+namespace {
+    // The alignment of the memory, the offsets, and the sizes of writes with O_DIRECT,
+    // which covers the logical block size of all common disks
+    constexpr size_t DirectAlignment = 4096;
+
+    struct FreeDeleter {
+        void operator()(unsigned char* p) const { std::free(p); }
+    };
+} // namespace
+
+namespace sgct {
+
+struct CaptureWriter::File {
+    std::filesystem::path filename;
+    std::vector<unsigned char> data;
+    /// The copy of the data that is written with O_DIRECT, aligned and padded to
+    /// `DirectAlignment`
+    std::unique_ptr<unsigned char, FreeDeleter> aligned;
+    /// The size of the file
+    size_t size = 0;
+    /// The number of bytes that are written, which includes the padding for O_DIRECT
+    size_t writeSize = 0;
+
+    int fd = -1;
+    size_t nSubmitted = 0;
+    size_t nWritten = 0;
+    int nInFlight = 0;
+    bool hasFailed = false;
+
+    const unsigned char* bytes() const {
+        return aligned ? aligned.get() : data.data();
+    }
+};
+
+#ifdef SGCT_HAS_IO_URING
+
+struct CaptureWriter::Ring {
+    /// A write that has been submitted to the ring
+    struct Piece {
+        File* file = nullptr;
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    ~Ring();
+
+    /// Sets up a ring with \p nEntries entries and returns `false` if the kernel does not
+    /// support io_uring or writes through it
+    bool initialize(unsigned int nEntries);
+
+    /// Adds the write of the piece with the index \p piece to the submission queue
+    void prepare(int piece);
+
+    /// Submits the prepared writes and waits until at least \p nWait have completed.
+    /// Returns `false` if the kernel rejected the submission, in which case the pieces
+    /// that were not submitted are moved to \p rejected
+    bool enter(unsigned int nWait, std::vector<int>& rejected);
+
+    int fd = -1;
+    void* sqRing = nullptr;
+    size_t sqRingSize = 0;
+    void* cqRing = nullptr;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned int* sqTail = nullptr;
+    unsigned int* sqMask = nullptr;
+    unsigned int* sqArray = nullptr;
+    unsigned int* cqHead = nullptr;
+    unsigned int* cqTail = nullptr;
+    unsigned int* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    /// Every piece has at most one entry in the submission queue, so there can never be
+    /// more pieces in flight than the queue has entries
+    std::vector<Piece> pieces;
+    std::vector<int> freePieces;
+    /// The pieces that have been prepared but not submitted yet, in the order of their
+    /// entries in the submission queue
+    std::vector<int> unsubmitted;
+};
+
+CaptureWriter::Ring::~Ring() {
+    if (sqes) {
+        munmap(sqes, sqesSize);
+    }
+    if (cqRing && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    if (sqRing) {
+        munmap(sqRing, sqRingSize);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool CaptureWriter::Ring::initialize(unsigned int nEntries) {
+    io_uring_params params = {};
+    fd = static_cast<int>(syscall(__NR_io_uring_setup, nEntries, &params));
+    if (fd < 0) {
+        return false;
+    }
+
+    // IORING_OP_WRITE was added after the ring itself, so the kernel has to be asked
+    // whether it supports it
+    std::vector<unsigned char> probeBuffer(
+        sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)
+    );
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+    const long res =
+        syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256);
+    if (res < 0 || probe->last_op < IORING_OP_WRITE ||
+        !(probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED))
+    {
+        return false;
+    }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool isSingleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (isSingleMapping) {
+        sqRingSize = std::max(sqRingSize, cqRingSize);
+        cqRingSize = sqRingSize;
+    }
+
+    const int prot = PROT_READ | PROT_WRITE;
+    const int flags = MAP_SHARED | MAP_POPULATE;
+    sqRing = mmap(nullptr, sqRingSize, prot, flags, fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        return false;
+    }
+    if (isSingleMapping) {
+        cqRing = sqRing;
+    }
+    else {
+        cqRing = mmap(nullptr, cqRingSize, prot, flags, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            return false;
+        }
+    }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* s = mmap(nullptr, sqesSize, prot, flags, fd, IORING_OFF_SQES);
+    if (s == MAP_FAILED) {
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(s);
+
+    unsigned char* sq = static_cast<unsigned char*>(sqRing);
+    sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+    unsigned char* cq = static_cast<unsigned char*>(cqRing);
+    cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    pieces.resize(params.sq_entries);
+    for (int i = static_cast<int>(pieces.size()) - 1; i >= 0; i--) {
+        freePieces.push_back(i);
+    }
+    return true;
+}
+
+void CaptureWriter::Ring::prepare(int piece) {
+    const Piece& p = pieces[piece];
+
+    // This thread is the only producer, so the tail can be read without synchronization
+    const unsigned int tail = *sqTail;
+    const unsigned int index = tail & *sqMask;
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(io_uring_sqe));
+    sqe.opcode = IORING_OP_WRITE;
+    sqe.fd = p.file->fd;
+    sqe.addr = reinterpret_cast<uint64_t>(p.file->bytes() + p.offset);
+    sqe.len = static_cast<uint32_t>(p.length);
+    sqe.off = p.offset;
+    sqe.user_data = static_cast<uint64_t>(piece);
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    unsubmitted.push_back(piece);
+}
+
+bool CaptureWriter::Ring::enter(unsigned int nWait, std::vector<int>& rejected) {
+    while (true) {
+        const unsigned int nSubmit = static_cast<unsigned int>(unsubmitted.size());
+        const unsigned int flags = nWait > 0 ? IORING_ENTER_GETEVENTS : 0;
+        const long res =
+            syscall(__NR_io_uring_enter, fd, nSubmit, nWait, flags, nullptr, 0);
+        if (res >= 0) {
+            unsubmitted.erase(unsubmitted.begin(), unsubmitted.begin() + res);
+            return true;
+        }
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            // The entries that the kernel did not take are removed again, so that they
+            // are not submitted with the next call
+            __atomic_store_n(sqTail, *sqTail - nSubmit, __ATOMIC_RELEASE);
+            rejected = std::move(unsubmitted);
+            unsubmitted.clear();
+            return false;
+        }
+    }
+}
+
+#else // ^^^^ SGCT_HAS_IO_URING // !SGCT_HAS_IO_URING vvvv
+
+struct CaptureWriter::Ring {};
+
+#endif // SGCT_HAS_IO_URING
+
+CaptureWriter::CaptureWriter(Settings settings)
+    : _settings(std::move(settings))
+    , _chunkSize(
+        (std::max(_settings.chunkSize, size_t(1)) + DirectAlignment - 1) /
+        DirectAlignment * DirectAlignment
+    )
+{
+#ifdef SGCT_HAS_IO_URING
+    if (_settings.useIoUring) {
+        auto ring = std::make_unique<Ring>();
+        const int nEntries = std::max(_settings.queueDepth, 1);
+        if (ring->initialize(static_cast<unsigned int>(nEntries))) {
+            _ring = std::move(ring);
+            _backend = Backend::IoUring;
+        }
+        else {
+            Log::Warning(
+                "The kernel does not support writes through io_uring, captured files are "
+                "written with blocking writes"
+            );
+        }
+    }
+#endif // SGCT_HAS_IO_URING
+
+    Log::Debug(std::format(
+        "Writing captured files with {}", _ring ? "io_uring" : "a writer thread"
+    ));
+    _thread = std::thread(&CaptureWriter::run, this);
+}
+
+CaptureWriter::~CaptureWriter() {
+    {
+        const std::unique_lock lock(_mutex);
+        _isStopping = true;
+    }
+    _hasFiles.notify_one();
+    _thread.join();
+
+    if (_nFailedFiles > 0) {
+        Log::Warning(std::format(
+            "{} captured files could not be written", _nFailedFiles
+        ));
+    }
+}
+
+void CaptureWriter::write(std::filesystem::path filename, std::vector<unsigned char> data)
+{
+    ZoneScoped;
+
+    File file;
+    file.filename = std::move(filename);
+    file.size = data.size();
+    file.writeSize = file.size;
+#ifdef __linux__
+    if (_settings.useDirectIO && file.size > 0) {
+        const size_t padded =
+            (file.size + DirectAlignment - 1) / DirectAlignment * DirectAlignment;
+        file.aligned.reset(
+            static_cast<unsigned char*>(std::aligned_alloc(DirectAlignment, padded))
+        );
+        if (file.aligned) {
+            std::memcpy(file.aligned.get(), data.data(), file.size);
+            std::memset(file.aligned.get() + file.size, 0, padded - file.size);
+            file.writeSize = padded;
+            data = std::vector<unsigned char>();
+        }
+    }
+#endif // __linux__
+    file.data = std::move(data);
+
+    std::unique_lock lock(_mutex);
+    // A file that is larger than the limit on its own is added once the queue is empty
+    _hasSpace.wait(
+        lock,
+        [this, size = file.size]() {
+            return _nQueuedBytes == 0 || _nQueuedBytes + size <= _settings.maxQueuedBytes;
+        }
+    );
+    _nQueuedBytes += file.size;
+    _nUnfinishedFiles++;
+    _queue.push_back(std::move(file));
+    lock.unlock();
+    _hasFiles.notify_one();
+}
+
+void CaptureWriter::flush() {
+    std::unique_lock lock(_mutex);
+    _isDone.wait(lock, [this]() { return _nUnfinishedFiles == 0; });
+}
+
+CaptureWriter::Backend CaptureWriter::backend() const {
+    return _backend;
+}
+
+uint64_t CaptureWriter::nFailedFiles() const {
+    const std::unique_lock lock(_mutex);
+    return _nFailedFiles;
+}
+
+void CaptureWriter::run() {
+    // The files that the writer thread has taken from the queue and is writing
+    std::list<File> files;
+    while (true) {
+        {
+            std::unique_lock lock(_mutex);
+            if (files.empty()) {
+                _hasFiles.wait(lock, [this]() { return _isStopping || !_queue.empty(); });
+                if (_queue.empty()) {
+                    // The writer is stopping and all files have been written
+                    return;
+                }
+            }
+            files.splice(files.end(), _queue);
+        }
+
+        if (_ring) {
+            writeRing(files);
+        }
+        else {
+            writeBlocking(files.front());
+            finish(files.front());
+            files.pop_front();
+        }
+    }
+}
+
+void CaptureWriter::writeRing([[maybe_unused]] std::list<File>& files) {
+#ifdef SGCT_HAS_IO_URING
+    ZoneScoped;
+
+    Ring& ring = *_ring;
+
+    // The free pieces go to the files in the order in which they were added, so that
+    // the oldest file is finished first while the pieces of the following files keep
+    // the disk busy
+    for (File& file : files) {
+        if (ring.freePieces.empty()) {
+            break;
+        }
+        if (file.hasFailed || (file.fd < 0 && !open(file))) {
+            continue;
+        }
+        while (file.nSubmitted < file.writeSize && !ring.freePieces.empty()) {
+            const int piece = ring.freePieces.back();
+            ring.freePieces.pop_back();
+            ring.pieces[piece] = Ring::Piece{
+                &file,
+                file.nSubmitted,
+                std::min(file.writeSize - file.nSubmitted, _chunkSize)
+            };
+            ring.prepare(piece);
+            file.nSubmitted += ring.pieces[piece].length;
+            file.nInFlight++;
+        }
+    }
+
+    const bool hasPiecesInFlight = ring.freePieces.size() < ring.pieces.size();
+    std::vector<int> rejected;
+    if (!ring.enter(hasPiecesInFlight ? 1 : 0, rejected)) {
+        Log::Error(std::format(
+            "Failed to submit writes of captured files: {}", std::strerror(errno)
+        ));
+        for (int piece : rejected) {
+            File& file = *ring.pieces[piece].file;
+            file.hasFailed = true;
+            file.nInFlight--;
+            ring.pieces[piece] = Ring::Piece();
+            ring.freePieces.push_back(piece);
+        }
+    }
+
+    // Process all completed writes
+    unsigned int head = *ring.cqHead;
+    const unsigned int tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+        const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+        const int piece = static_cast<int>(cqe.user_data);
+        Ring::Piece& p = ring.pieces[piece];
+        File& file = *p.file;
+
+        if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+            ring.prepare(piece);
+            continue;
+        }
+        if (cqe.res > 0 && static_cast<size_t>(cqe.res) < p.length) {
+            // A short write, the rest of the piece is written again
+            file.nWritten += cqe.res;
+            p.offset += cqe.res;
+            p.length -= cqe.res;
+            ring.prepare(piece);
+            continue;
+        }
+
+        if (cqe.res <= 0) {
+            if (!file.hasFailed) {
+                Log::Error(std::format(
+                    "Error writing file '{}': {}",
+                    file.filename, std::strerror(cqe.res < 0 ? -cqe.res : ENOSPC)
+                ));
+            }
+            file.hasFailed = true;
+        }
+        else {
+            file.nWritten += p.length;
+        }
+        file.nInFlight--;
+        p = Ring::Piece();
+        ring.freePieces.push_back(piece);
+    }
+    __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+
+    // Close the files that are done
+    for (auto it = files.begin(); it != files.end();) {
+        const bool isDone =
+            it->nInFlight == 0 &&
+            (it->hasFailed || (it->fd >= 0 && it->nWritten == it->writeSize));
+        if (isDone) {
+            close(*it);
+            finish(*it);
+            it = files.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+#endif // SGCT_HAS_IO_URING
+}
+
+void CaptureWriter::writeBlocking(File& file) {
+    ZoneScoped;
+
+#ifdef WIN32
+    const std::string f = file.filename.string();
+    FILE* fp = fopen(f.c_str(), "wb");
+    if (!fp) {
+        Log::Error(std::format("Cannot create file '{}'", f));
+        file.hasFailed = true;
+        return;
+    }
+    file.nWritten = fwrite(file.bytes(), 1, file.size, fp);
+    fclose(fp);
+    if (file.nWritten != file.size) {
+        Log::Error(std::format("Error writing file '{}'", f));
+        file.hasFailed = true;
+        std::filesystem::remove(file.filename);
+    }
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    if (!open(file)) {
+        return;
+    }
+    const unsigned char* bytes = file.bytes();
+    while (file.nWritten < file.writeSize) {
+        const size_t n = std::min(file.writeSize - file.nWritten, _chunkSize);
+        const ssize_t res = pwrite(
+            file.fd,
+            bytes + file.nWritten,
+            n,
+            static_cast<off_t>(file.nWritten)
+        );
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (res <= 0) {
+            Log::Error(std::format(
+                "Error writing file '{}': {}",
+                file.filename, std::strerror(res < 0 ? errno : ENOSPC)
+            ));
+            file.hasFailed = true;
+            break;
+        }
+        file.nWritten += static_cast<size_t>(res);
+    }
+    close(file);
+#endif // WIN32
+}
+
+#ifndef WIN32
+
+bool CaptureWriter::open(File& file) {
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+#ifdef __linux__
+    if (file.aligned) {
+        flags |= O_DIRECT;
+    }
+#endif // __linux__
+    file.fd = ::open(file.filename.c_str(), flags, 0644);
+#ifdef __linux__
+    if (file.fd < 0 && errno == EINVAL && file.aligned) {
+        // The file system does not support O_DIRECT, the padded data is still written
+        // and truncated afterwards
+        file.fd = ::open(file.filename.c_str(), flags & ~O_DIRECT, 0644);
+    }
+#endif // __linux__
+    if (file.fd < 0) {
+        Log::Error(std::format(
+            "Cannot create file '{}': {}", file.filename, std::strerror(errno)
+        ));
+        file.hasFailed = true;
+        return false;
+    }
+
+#ifdef __linux__
+    if (_settings.preallocate && file.writeSize > 0) {
+        // Not all file systems support this, in which case the file grows as usual
+        [[maybe_unused]] const int res =
+            fallocate(file.fd, 0, 0, static_cast<off_t>(file.writeSize));
+    }
+#endif // __linux__
+    return true;
+}
+
+void CaptureWriter::close(File& file) {
+    if (file.fd < 0) {
+        return;
+    }
+
+    if (!file.hasFailed && file.writeSize != file.size &&
+        ftruncate(file.fd, static_cast<off_t>(file.size)) != 0)
+    {
+        Log::Error(std::format(
+            "Cannot truncate file '{}': {}", file.filename, std::strerror(errno)
+        ));
+        file.hasFailed = true;
+    }
+    ::close(file.fd);
+    file.fd = -1;
+
+    if (file.hasFailed) {
+        std::error_code ec;
+        std::filesystem::remove(file.filename, ec);
+    }
+}
+
+#endif // WIN32
+
+void CaptureWriter::finish(const File& file) {
+    {
+        const std::unique_lock lock(_mutex);
+        _nQueuedBytes -= file.size;
+        _nUnfinishedFiles--;
+        if (file.hasFailed) {
+            _nFailedFiles++;
+        }
+    }
+    _hasSpace.notify_all();
+    _isDone.notify_all();
+}
+
+} // namespace sgct
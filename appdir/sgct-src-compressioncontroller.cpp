@@ -0,0 +1,134 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/compressioncontroller.h>
+
+#include <sgct/format.h>
+#include <sgct/log.h>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string_view>
+
+namespace sgct {
+
+namespace {
+    using Filter = Image::PngFilter;
+
+    // The settings from the fastest to the one with the smallest files. Filtering the
+    // rows makes the data compress both faster and better than unfiltered rows for
+    // rendered content, so apart from storing the data uncompressed, all steps filter
+    constexpr std::array<CompressionController::Setting, 6> Steps = {
+        CompressionController::Setting{ 0, Filter::None },
+        CompressionController::Setting{ 1, Filter::Up },
+        CompressionController::Setting{ 2, Filter::Up },
+        CompressionController::Setting{ 3, Filter::Up },
+        CompressionController::Setting{ 5, Filter::Up },
+        CompressionController::Setting{ 6, Filter::Up }
+    };
+
+    // Switching to smaller files requires this much of the budget to be left, as the
+    // next step is usually considerably slower
+    constexpr double Headroom = 0.6;
+
+    // The number of frames that have to be measured before switching to faster or
+    // smaller settings. Switching to faster settings reacts quicker to avoid dropping
+    // frames
+    constexpr int SamplesBeforeFaster = 2;
+    constexpr int SamplesBeforeSmaller = 8;
+
+    // The weight of a new measurement in the moving average of the durations
+    constexpr double Smoothing = 0.3;
+
+    std::string_view filterName(Filter filter) {
+        switch (filter) {
+            case Filter::None: return "no";
+            case Filter::Sub: return "sub";
+            case Filter::Up: return "up";
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }
+} // namespace
+
+CompressionController::CompressionController(double budget, size_t queueLength,
+                                             Setting initial)
+    : _budget(budget)
+    , _queueLength(queueLength)
+{
+    auto it = std::find(Steps.begin(), Steps.end(), initial);
+    if (it == Steps.end()) {
+        it = std::find_if(
+            Steps.begin(),
+            Steps.end(),
+            [&initial](const Setting& s) { return s.level >= initial.level; }
+        );
+    }
+    _step = it == Steps.end() ? static_cast<int>(Steps.size()) - 1 :
+        static_cast<int>(std::distance(Steps.begin(), it));
+
+    Log::Info(std::format(
+        "Adaptive PNG compression with a budget of {:.1f} ms per frame, starting with "
+        "level {} and {} filter",
+        _budget * 1000.0, Steps[_step].level, filterName(Steps[_step].filter)
+    ));
+}
+
+CompressionController::Setting CompressionController::current() const {
+    const std::unique_lock lock(_mutex);
+    return Steps[_step];
+}
+
+void CompressionController::reportDuration(const Setting& setting, double duration) {
+    const std::unique_lock lock(_mutex);
+    if (setting != Steps[_step]) {
+        // The frame was started before the last switch
+        return;
+    }
+    _averageDuration =
+        _nSamples == 0 ?
+        duration :
+        Smoothing * duration + (1.0 - Smoothing) * _averageDuration;
+    _nSamples++;
+    update();
+}
+
+void CompressionController::reportQueueDepth(size_t depth) {
+    const std::unique_lock lock(_mutex);
+    _queueDepth = depth;
+    update();
+}
+
+void CompressionController::update() {
+    const bool isBehind = _averageDuration > _budget || _queueDepth >= _queueLength;
+    const bool hasTimeLeft = _averageDuration < Headroom * _budget && _queueDepth == 0;
+
+    int step = _step;
+    if (isBehind && _nSamples >= SamplesBeforeFaster && _step > 0) {
+        step = _step - 1;
+    }
+    else if (hasTimeLeft && _nSamples >= SamplesBeforeSmaller &&
+             _step < static_cast<int>(Steps.size()) - 1)
+    {
+        step = _step + 1;
+    }
+    if (step == _step) {
+        return;
+    }
+
+    Log::Info(std::format(
+        "Adaptive PNG compression switched to level {} with {} filter ({:.1f} ms per "
+        "frame with level {}, budget {:.1f} ms, {} frames queued)",
+        Steps[step].level, filterName(Steps[step].filter), _averageDuration * 1000.0,
+        Steps[_step].level, _budget * 1000.0, _queueDepth
+    ));
+    _step = step;
+    _averageDuration = 0.0;
+    _nSamples = 0;
+}
+
+} // namespace sgct
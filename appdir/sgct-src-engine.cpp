@@ -0,0 +1,1270 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/baseviewport.h>
+#include <sgct/engine.h>
+#include <sgct/capturestatisticsrenderer.h>
+#include <sgct/clustermanager.h>
+#include <sgct/commandline.h>
+#include <sgct/error.h>
+#include <sgct/fontmanager.h>
+#include <sgct/framelockbarrier.h>
+#include <sgct/log.h>
+#include <sgct/network.h>
+#include <sgct/networkmanager.h>
+#include <sgct/node.h>
+#include <sgct/profiling.h>
+#include <sgct/screencapture.h>
+#include <sgct/shadermanager.h>
+#include <sgct/shareddata.h>
+#include <sgct/sharedframe.h>
+#include <sgct/statisticshistory.h>
+#include <sgct/statisticsrenderer.h>
+#include <sgct/texturemanager.h>
+#ifdef SGCT_HAS_VRPN
+#include <sgct/trackingmanager.h>
+#endif // SGCT_HAS_VRPN
+#include <sgct/version.h>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef WIN32
+#include <glad/glad_wgl.h>
+#include <Windows.h>
+#else // ^^^^ WIN32 // !WIN32 vvvv
+#include <glad/glad.h>
+#endif // WIN32
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#ifdef SGCT_HAS_NDI
+#include <Processing.NDI.Lib.h>
+#endif // SGCT_HAS_NDI
+
+#define Err(code, msg) Error(Error::Component::Engine, code, msg)
+
+namespace sgct {
+
+namespace {
+    FrameLockBarrier Barrier(NetworkManager::mutex, NetworkManager::cond);
+
+    // Callback wrappers for GLFW
+    std::function<void(Key, Modifier, Action, int, Window*)> gKeyboardCallback = nullptr;
+    std::function<void(unsigned int, int, Window*)> gCharCallback = nullptr;
+    std::function<void(MouseButton, Modifier, Action, Window*)>
+        gMouseButtonCallback = nullptr;
+    std::function<void(double, double, Window*)> gMousePosCallback = nullptr;
+    std::function<void(double, double, Window*)> gMouseScrollCallback = nullptr;
+    std::function<void(std::vector<std::string_view>)> gDropCallback = nullptr;
+
+    // Windows with this tag publish their frames through shared memory
+    constexpr std::string_view SharedMemoryTag = "SharedMemoryOut";
+
+    // The shared memory outputs of a window, with a publisher for each eye for stereo
+    struct SharedMemoryOutput {
+        Window* window = nullptr;
+        std::unique_ptr<SharedFramePublisher> leftOrMain;
+        std::unique_ptr<SharedFramePublisher> right;
+    };
+    std::vector<SharedMemoryOutput> SharedMemoryOutputs;
+
+    void createSharedMemoryOutputs(const std::vector<std::unique_ptr<Window>>& windows) {
+        for (const std::unique_ptr<Window>& window : windows) {
+            if (!window->hasTag(SharedMemoryTag)) {
+                continue;
+            }
+
+#ifndef WIN32
+            const std::string name = std::format(
+                "sgct-{}",
+                window->name().empty() ? std::format("win{}", window->id()) :
+                                         window->name()
+            );
+            const Window::StereoMode sm = window->stereoMode();
+            const bool hasStereo = sm != Window::StereoMode::NoStereo &&
+                                   sm < Window::StereoMode::SideBySide;
+
+            using Publisher = SharedFramePublisher;
+            SharedMemoryOutput output;
+            output.window = window.get();
+            if (hasStereo) {
+                output.leftOrMain = std::make_unique<Publisher>(name + "_left");
+                output.right = std::make_unique<Publisher>(name + "_right");
+            }
+            else {
+                output.leftOrMain = std::make_unique<Publisher>(name);
+            }
+            Log::Info(std::format("Publishing window frames as '{}'", name));
+            SharedMemoryOutputs.push_back(std::move(output));
+#else // ^^^^ !WIN32 // WIN32 vvvv
+            Log::Warning(
+                "Shared memory output is only supported on Linux and macOS, use Spout"
+            );
+#endif // WIN32
+        }
+    }
+
+    void publishSharedMemoryOutputs(uint64_t frameNumber) {
+        for (const SharedMemoryOutput& output : SharedMemoryOutputs) {
+            const ivec2 size = output.window->framebufferResolution();
+            output.leftOrMain->publish(
+                output.window->frameBufferTextureEye(Eye::MonoOrLeft),
+                size,
+                frameNumber
+            );
+            if (output.right) {
+                output.right->publish(
+                    output.window->frameBufferTextureEye(Eye::Right),
+                    size,
+                    frameNumber
+                );
+            }
+        }
+    }
+
+    // The captures of stereo windows that read both eyes into a single frame, see
+    // ScreenCapture::Settings::combineStereo
+    struct StereoCapture {
+        const Window* window = nullptr;
+        std::unique_ptr<ScreenCapture> capture;
+        ivec2 resolution = ivec2{ 0, 0 };
+    };
+    std::vector<StereoCapture> StereoCaptures;
+
+    // Captures both eyes of the \p window into a single frame. Returns `false` if the
+    // eyes of the window have to be captured by the window instead, as it is not a
+    // stereo window, combining is disabled, or the eyes already share a texture
+    bool captureStereo(const Window& window, bool fromBackBuffer) {
+        const Window::StereoMode sm = window.stereoMode();
+        if (!ScreenCapture::settings().combineStereo ||
+            sm == Window::StereoMode::NoStereo || sm >= Window::StereoMode::SideBySide)
+        {
+            return false;
+        }
+
+        auto it = std::find_if(
+            StereoCaptures.begin(),
+            StereoCaptures.end(),
+            [&window](const StereoCapture& c) { return c.window == &window; }
+        );
+        if (it == StereoCaptures.end()) {
+            std::unique_ptr<ScreenCapture> c = ScreenCapture::createStereoCapture(window);
+            if (!c) {
+                return false;
+            }
+            StereoCaptures.push_back({ &window, std::move(c) });
+            it = StereoCaptures.end() - 1;
+        }
+
+        const ivec2 resolution = window.framebufferResolution();
+        if (resolution.x != it->resolution.x || resolution.y != it->resolution.y) {
+            it->capture->resize(resolution);
+            it->resolution = resolution;
+        }
+        using Source = ScreenCapture::CaptureSource;
+        it->capture->saveStereoScreenCapture(
+            window.frameBufferTextureEye(Eye::MonoOrLeft),
+            window.frameBufferTextureEye(Eye::Right),
+            fromBackBuffer ? Source::BackBuffer : Source::Texture
+        );
+        return true;
+    }
+
+    // The draw time is measured with pairs of timestamp queries whose results are read a
+    // few frames later, once the GPU has finished those frames, so that the measurement
+    // never makes the CPU wait for the GPU
+    struct DrawTimeQueries {
+        static constexpr int Count = 4;
+
+        std::array<unsigned int, Count> begin = {};
+        std::array<unsigned int, Count> end = {};
+        std::array<bool, Count> isPending = {};
+        // The pair that is used in the next frame, which is also the oldest pair
+        int next = 0;
+    };
+
+    // Adds the draw times of all frames whose queries have finished to \p drawTimes
+    void collectDrawTimes(DrawTimeQueries& queries, StatisticsHistory& drawTimes) {
+        for (int i = 0; i < DrawTimeQueries::Count; i++) {
+            const int q = (queries.next + i) % DrawTimeQueries::Count;
+            if (!queries.isPending[q]) {
+                continue;
+            }
+            GLint isAvailable = GL_FALSE;
+            glGetQueryObjectiv(queries.end[q], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+            if (!isAvailable) {
+                // The frames finish in order, so the newer ones are not done yet either
+                break;
+            }
+
+            GLuint64 timerStart = 0;
+            glGetQueryObjectui64v(queries.begin[q], GL_QUERY_RESULT, &timerStart);
+            GLuint64 timerEnd = 0;
+            glGetQueryObjectui64v(queries.end[q], GL_QUERY_RESULT, &timerEnd);
+            queries.isPending[q] = false;
+
+            const double t = static_cast<double>(timerEnd - timerStart) / 1000000000.0;
+            drawTimes.add(t);
+        }
+    }
+
+    Engine::Settings createSettings(config::Cluster cluster, const Configuration& config)
+    {
+        Engine::Settings res;
+
+        res.capture.nCaptureThreads =
+            config.nCaptureThreads.value_or(res.capture.nCaptureThreads);
+        res.createDebugContext =
+            config.useOpenGLDebugContext.value_or(res.createDebugContext);
+        res.capture.capturePath = config.screenshotPath.value_or(res.capture.capturePath);
+        res.capture.prefix = config.screenshotPrefix.value_or(res.capture.prefix);
+        res.capture.addNodeName =
+            config.addNodeNameInScreenshot.value_or(res.capture.addNodeName);
+        if (config.omitWindowNameInScreenshot) {
+            res.capture.addWindowName = !(*config.omitWindowNameInScreenshot);
+        }
+        if (cluster.settings) {
+            if (cluster.settings->display) {
+                res.swapInterval = cluster.settings->display->swapInterval.value_or(
+                    res.swapInterval
+                );
+            }
+            res.useDepthTexture =
+                cluster.settings->useDepthTexture.value_or(res.useDepthTexture);
+            res.useNormalTexture =
+                cluster.settings->useNormalTexture.value_or(res.useNormalTexture);
+            res.usePositionTexture =
+                cluster.settings->usePositionTexture.value_or(res.usePositionTexture);
+        }
+        if (cluster.capture) {
+            res.capture.capturePath =
+                cluster.capture->path.value_or(res.capture.capturePath);
+
+            if (cluster.capture->range) {
+                res.capture.limits = {
+                    static_cast<uint64_t>(cluster.capture->range->first),
+                    static_cast<uint64_t>(cluster.capture->range->last)
+                };
+            }
+        }
+
+        return res;
+    }
+} // namespace
+
+double Engine::Statistics::dt() const {
+    return frametimes.newest();
+}
+
+double Engine::Statistics::avgDt() const {
+    return frametimes.average();
+}
+
+double Engine::Statistics::minDt() const {
+    return frametimes.min();
+}
+
+double Engine::Statistics::maxDt() const {
+    return frametimes.max();
+}
+
+StatisticsHistory::Percentiles Engine::Statistics::frameTimePercentiles() const {
+    return frametimes.percentiles();
+}
+
+StatisticsHistory::Percentiles Engine::Statistics::drawTimePercentiles() const {
+    return drawTimes.percentiles();
+}
+
+StatisticsHistory::Percentiles Engine::Statistics::syncTimePercentiles() const {
+    return syncTimes.percentiles();
+}
+
+Engine* Engine::_instance = nullptr;
+
+Engine& Engine::instance() {
+    if (_instance == nullptr) {
+        throw std::logic_error("Using the instance before it was created or set");
+    }
+    return *_instance;
+}
+
+void Engine::create(config::Cluster cluster, Callbacks callbacks,
+                    const Configuration& arg)
+{
+    ZoneScoped;
+
+    if (_instance) {
+        throw std::logic_error("Creating the instance when one already existed");
+    }
+
+    // (2019-12-02, abock) Unfortunately I couldn't find a better why than using this two
+    // phase initialization approach. There are a few callbacks in the second phase that
+    // are calling out to client code that (rightly) assumes that the Engine has been
+    // created and are calling Engine::instance from they registered callbacks. If this
+    // client code is executed from the constructor, the _instance variable has not yet
+    // been set and will therefore cause the logic_error in the instance() function
+    _instance = new Engine(std::move(cluster), std::move(callbacks), arg);
+    _instance->initialize();
+}
+
+void Engine::destroy() {
+    ZoneScoped;
+
+    delete _instance;
+    _instance = nullptr;
+}
+
+config::Cluster loadCluster(std::optional<std::filesystem::path> path) {
+    ZoneScoped;
+
+    if (path) {
+        assert(std::filesystem::exists(*path) && std::filesystem::is_regular_file(*path));
+        try {
+            Log::Debug(std::format("Parsing config '{}'", path->string()));
+            config::Cluster cluster = readConfig(*path);
+
+            Log::Debug("Config file read successfully");
+            Log::Info(std::format("Number of nodes: {}", cluster.nodes.size()));
+
+            for (size_t i = 0; i < cluster.nodes.size(); i++) {
+                const config::Node& node = cluster.nodes[i];
+                Log::Info(std::format(
+                    "\tNode ({}) address: {} [{}]", i, node.address, node.port
+                ));
+            }
+            return cluster;
+        }
+        catch (const std::runtime_error& e) {
+            std::cout << e.what() << '\n';
+            std::cout << helpMessage() << '\n';
+            throw;
+        }
+        catch (...) {
+            std::cout << helpMessage() << '\n';
+            throw;
+        }
+    }
+    else {
+        return defaultCluster();
+    }
+}
+
+double time() {
+    return glfwGetTime();
+}
+
+Engine::Engine(config::Cluster cluster, Callbacks callbacks, const Configuration& config)
+    : _preWindowFn(std::move(callbacks.preWindow))
+    , _initOpenGLFn(std::move(callbacks.initOpenGL))
+    , _preSyncFn(std::move(callbacks.preSync))
+    , _postSyncPreDrawFn(std::move(callbacks.postSyncPreDraw))
+    , _drawFn(std::move(callbacks.draw))
+    , _draw2DFn(std::move(callbacks.draw2D))
+    , _postDrawFn(std::move(callbacks.postDraw))
+    , _cleanupFn(std::move(callbacks.cleanup))
+    , _settings(createSettings(cluster, config))
+{
+    ZoneScoped;
+
+    SharedData::instance().setEncodeFunction(std::move(callbacks.encode));
+    SharedData::instance().setDecodeFunction(std::move(callbacks.decode));
+
+    gKeyboardCallback = std::move(callbacks.keyboard);
+    gCharCallback = std::move(callbacks.character);
+    gMouseButtonCallback = std::move(callbacks.mouseButton);
+    gMousePosCallback = std::move(callbacks.mousePos);
+    gMouseScrollCallback = std::move(callbacks.mouseScroll);
+    gDropCallback = std::move(callbacks.drop);
+
+    NetworkManager::NetworkMode netMode = NetworkManager::NetworkMode::Remote;
+    if (config.isServer) {
+        netMode = *config.isServer ?
+            NetworkManager::NetworkMode::LocalServer :
+            NetworkManager::NetworkMode::LocalClient;
+    }
+    if (config.logLevel) {
+        Log::instance().setNotifyLevel(*config.logLevel);
+    }
+    if (config.showHelpText) {
+        std::cout << helpMessage() << '\n';
+        std::exit(0);
+    }
+
+    if (config.firmSync) {
+        cluster.firmSync = config.firmSync;
+    }
+
+    if (cluster.threadAffinity) {
+#ifdef WIN32
+        SetThreadAffinityMask(GetCurrentThread(), *cluster.threadAffinity);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        Log::Error("Using thread affinity on an operating system that is not supported");
+#endif // WIN32
+    }
+    {
+        ZoneScopedN("GLFW initialization");
+
+        glfwSetErrorCallback(
+            [](int error, const char* desc) {
+                throw Err(3010, std::format("GLFW error ({}): {}", error, desc));
+            }
+        );
+        const int res = glfwInit();
+        if (res == GLFW_FALSE) {
+            throw Err(3000, "Failed to initialize GLFW");
+        }
+    }
+
+    Log::Info(std::format("SGCT version: {}", Version));
+
+    Log::Debug("Validating cluster configuration");
+    config::validateCluster(cluster);
+
+    NetworkManager::create(
+        netMode,
+        std::move(callbacks.dataTransferDecode),
+        std::move(callbacks.dataTransferStatus),
+        std::move(callbacks.dataTransferAcknowledge)
+    );
+#ifdef SGCT_HAS_VRPN
+    for (const config::Tracker& tracker : cluster.trackers) {
+        TrackingManager::instance().applyTracker(tracker);
+    }
+#endif // SGCT_HAS_VRPN
+    int clusterId = -1;
+    // Check in cluster configuration which it is
+    if (netMode == NetworkManager::NetworkMode::Remote) {
+        Log::Debug("Matching ip address to find node in configuration");
+
+        for (size_t i = 0; i < cluster.nodes.size(); i++) {
+            if (NetworkManager::instance().matchesAddress(cluster.nodes[i].address)) {
+                clusterId = static_cast<int>(i);
+                Log::Debug(std::format("Running in cluster mode as node {}", i));
+                break;
+            }
+        }
+    }
+    else {
+        if (config.nodeId) {
+            if (*config.nodeId >= static_cast<int>(cluster.nodes.size())) {
+                NetworkManager::destroy();
+                throw Err(
+                    3001, "Requested node id was not found in the cluster configuration"
+                );
+            }
+            clusterId = *config.nodeId;
+            Log::Debug(std::format("Running locally as node {}", clusterId));
+        }
+        else {
+            throw Err(3002, "When running locally, a node ID needs to be specified");
+        }
+    }
+
+    if (clusterId < 0) {
+        NetworkManager::destroy();
+        throw Err(3003, "Computer is not a part of the cluster configuration");
+    }
+
+    ClusterManager::create(cluster, clusterId);
+    if (config.ignoreSync) {
+        ClusterManager::instance().setUseIgnoreSync(*config.ignoreSync);
+    }
+
+    NetworkManager::instance().initialize();
+}
+
+void Engine::initialize() {
+    ZoneScoped;
+
+    {
+        int major = 0;
+        int minor = 0;
+        int release = 0;
+        glfwGetVersion(&major, &minor, &release);
+        Log::Info(std::format("Using GLFW version {}.{}.{}", major, minor, release));
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+
+    const Node& thisNode = ClusterManager::instance().thisNode();
+    const std::vector<std::unique_ptr<Window>>& windows = thisNode.windows();
+
+    bool needsCompatProfile = std::any_of(
+        windows.cbegin(),
+        windows.cend(),
+        std::mem_fn(&Window::needsCompatibilityProfile)
+    );
+
+    glfwWindowHint(
+        GLFW_OPENGL_PROFILE,
+        needsCompatProfile ? GLFW_OPENGL_COMPAT_PROFILE : GLFW_OPENGL_CORE_PROFILE
+    );
+
+    if (_settings.createDebugContext) {
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+    }
+
+    if (_preWindowFn) {
+        ZoneScopedN("[SGCT] Pre-window creation");
+        _preWindowFn();
+    }
+
+    for (size_t i = 0; i < windows.size(); i++) {
+        ZoneScopedN("Creating Window");
+
+        GLFWwindow* s = (i == 0) ? nullptr : windows[0]->windowHandle();
+        const bool isLastWindow = i == windows.size() - 1;
+        windows[i]->openWindow(s, isLastWindow);
+        gladLoadGL();
+#ifdef WIN32
+        gladLoadWGL(wglGetCurrentDC());
+#endif // WIN32
+        TracyGpuContext;
+
+        if (i == 0) {
+            int major = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &major);
+            int minor = 0;
+            glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+            if (major != 4 || minor != 6) {
+                throw Err(
+                    3007,
+                    "Error creating OpenGL context with version 4.6 when initializing "
+                    "the engine"
+                );
+            }
+        }
+    }
+
+    // Clear directly otherwise junk will be displayed on some OSs (OS X Yosemite)
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Window resolution may have been set by the config. However, it only sets a pending
+    // resolution, so it needs to apply it using the same routine as in the end of a frame
+    const std::vector<std::unique_ptr<Window>>& wins = thisNode.windows();
+    std::for_each(wins.cbegin(), wins.cend(), std::mem_fn(&Window::updateResolutions));
+
+    // If a single node, skip syncing
+    if (ClusterManager::instance().numberOfNodes() == 1) {
+        ClusterManager::instance().setUseIgnoreSync(true);
+    }
+
+    for (const std::unique_ptr<Window>& window : wins) {
+        GLFWwindow* win = window->windowHandle();
+        if (gKeyboardCallback) {
+            glfwSetKeyCallback(
+                win,
+                [](GLFWwindow* w, int key, int scancode, int a, int m) {
+                    void* sgctWindow = glfwGetWindowUserPointer(w);
+                    gKeyboardCallback(
+                        Key(key),
+                        Modifier(m),
+                        Action(a),
+                        scancode,
+                        reinterpret_cast<Window*>(sgctWindow)
+                    );
+                }
+            );
+        }
+        if (gMouseButtonCallback) {
+            glfwSetMouseButtonCallback(
+                win,
+                [](GLFWwindow* w, int b, int a, int m) {
+                    void* sgctWindow = glfwGetWindowUserPointer(w);
+                    gMouseButtonCallback(
+                        MouseButton(b),
+                        Modifier(m),
+                        Action(a),
+                        reinterpret_cast<Window*>(sgctWindow)
+                    );
+                }
+            );
+        }
+        if (gMousePosCallback) {
+            glfwSetCursorPosCallback(
+                win,
+                [](GLFWwindow* w, double xPos, double yPos) {
+                    void* sgctWindow = glfwGetWindowUserPointer(w);
+                    gMousePosCallback(xPos, yPos, reinterpret_cast<Window*>(sgctWindow));
+                }
+            );
+        }
+        if (gCharCallback) {
+            glfwSetCharModsCallback(
+                win,
+                [](GLFWwindow* w, unsigned int ch, int mod) {
+                    void* sgctWindow = glfwGetWindowUserPointer(w);
+                    gCharCallback(ch, mod, reinterpret_cast<Window*>(sgctWindow));
+                }
+            );
+        }
+        if (gMouseScrollCallback) {
+            glfwSetScrollCallback(
+                win,
+                [](GLFWwindow* w, double xOffset, double yOffset) {
+                    void* sgctWindow = glfwGetWindowUserPointer(w);
+                    gMouseScrollCallback(
+                        xOffset,
+                        yOffset,
+                        reinterpret_cast<Window*>(sgctWindow)
+                    );
+                }
+            );
+        }
+        if (gDropCallback) {
+            glfwSetDropCallback(
+                win,
+                [](GLFWwindow*, int count, const char** paths) {
+                    std::vector<std::string_view> p;
+                    p.reserve(count);
+                    for (int i = 0; i < count; i++) {
+                        p.emplace_back(paths[i]);
+                    }
+                    gDropCallback(std::move(p));
+                }
+            );
+        }
+    }
+
+    // Get OpenGL version from the first window as there has to be one
+    GLFWwindow* winHandle = wins[0]->windowHandle();
+    const std::array<int, 3> v = {
+        glfwGetWindowAttrib(winHandle, GLFW_CONTEXT_VERSION_MAJOR),
+        glfwGetWindowAttrib(winHandle, GLFW_CONTEXT_VERSION_MINOR),
+        glfwGetWindowAttrib(winHandle, GLFW_CONTEXT_REVISION)
+    };
+    Log::Info(std::format("OpenGL version {}.{}.{} core profile", v[0], v[1], v[2]));
+
+    std::string vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+    Log::Info(std::format("Vendor: {}", vendor));
+    std::string renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    Log::Info(std::format("Renderer: {}", renderer));
+
+    Window::makeSharedContextCurrent();
+
+#ifdef SGCT_HAS_NDI
+    const bool initializeSuccess = NDIlib_initialize();
+    if (!initializeSuccess) {
+        Log::Error("Error initializing NDI");
+    }
+#endif // SGCT_HAS_NDI
+
+    if (_initOpenGLFn) {
+        Log::Info("Calling initialization callback");
+        ZoneScopedN("[SGCT] OpenGL Initialization");
+        GLFWwindow* share = thisNode.windows().front()->windowHandle();
+        _initOpenGLFn(share);
+    }
+
+    std::for_each(wins.cbegin(), wins.cend(), std::mem_fn(&Window::initialize));
+
+    updateFrustums();
+
+#ifdef SGCT_HAS_TEXT
+#ifdef WIN32
+    constexpr std::string_view FontName = "verdanab.ttf";
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    constexpr std::string_view FontName = "FreeSansBold.ttf";
+#endif // WIN32
+    text::FontManager::instance().addFont("SGCTFont", std::string(FontName));
+#endif // SGCT_HAS_TEXT
+
+    // Init draw buffer resolution
+    waitForAllWindowsInSwapGroupToOpen();
+    // Init swap group if enabled
+    if (thisNode.isUsingSwapGroups()) {
+        Window::initNvidiaSwapGroups();
+    }
+
+    // Init swap barrier is swap groups are active
+    Window::setBarrier(true);
+    Window::resetSwapGroupFrameNumber();
+
+    std::for_each(
+        wins.cbegin(),
+        wins.cend(),
+        std::mem_fn(&Window::initializeContextSpecific)
+    );
+
+    createSharedMemoryOutputs(wins);
+
+#ifdef SGCT_HAS_VRPN
+    // Start sampling tracking data
+    if (isMaster()) {
+        TrackingManager::instance().startSampling();
+    }
+#endif // SGCT_HAS_VRPN
+}
+
+Engine::~Engine() {
+    Log::Info("Cleaning up");
+
+    // First check whether we ever created a node for ourselves.  This might have failed
+    // if the configuration was illformed
+    const ClusterManager& cm = ClusterManager::instance();
+    const bool hasNode = cm.thisNodeId() > -1 && cm.thisNodeId() < cm.numberOfNodes();
+    if (hasNode) {
+        Window::makeSharedContextCurrent();
+        if (_cleanupFn) {
+            _cleanupFn();
+        }
+        // The readback buffers of the publishers and captures belong to the shared
+        // context
+        SharedMemoryOutputs.clear();
+        StereoCaptures.clear();
+    }
+
+    // We are only clearing the callbacks that might be called asynchronously
+    Log::Debug("Clearing callbacks");
+    NetworkManager::instance().clearCallbacks();
+    gKeyboardCallback = nullptr;
+    gMouseButtonCallback = nullptr;
+    gMousePosCallback = nullptr;
+    gMouseScrollCallback = nullptr;
+    gDropCallback = nullptr;
+
+    // Deinit window and unbind swapgroups
+    // There might not be any thisNode as its creation might have failed
+    if (hasNode) {
+        const std::vector<std::unique_ptr<Window>>& wins = cm.thisNode().windows();
+        std::for_each(wins.cbegin(), wins.cend(), std::mem_fn(&Window::closeWindow));
+    }
+
+    // Close TCP connections
+    Log::Debug("Destroying network manager");
+    NetworkManager::destroy();
+
+    // Shared contex
+    if (hasNode && !cm.thisNode().windows().empty()) {
+        Window::makeSharedContextCurrent();
+    }
+
+    Log::Debug("Destroying shader manager and internal shaders");
+    ShaderManager::destroy();
+
+    _statisticsRenderer = nullptr;
+    _captureStatisticsRenderer = nullptr;
+
+    Log::Debug("Destroying texture manager");
+    TextureManager::destroy();
+
+#ifdef SGCT_HAS_TEXT
+    Log::Debug("Destroying font manager");
+    text::FontManager::destroy();
+#endif // SGCT_HAS_TEXT
+
+    // Window specific context
+    if (hasNode && !cm.thisNode().windows().empty()) {
+        cm.thisNode().windows().front()->makeOpenGLContextCurrent();
+    }
+
+    Log::Debug("Destroying shared data");
+    SharedData::destroy();
+
+    Log::Debug("Destroying cluster manager");
+    ClusterManager::destroy();
+
+    Log::Debug("Destroying message handler");
+    Log::destroy();
+
+    Log::Debug("Terminating glfw");
+    glfwTerminate();
+
+    Log::Debug("Finished cleaning");
+}
+
+void Engine::terminate() {
+    _shouldTerminate = true;
+}
+
+void Engine::frameLockPreStage() {
+    ZoneScoped;
+
+    NetworkManager& nm = NetworkManager::instance();
+
+    const double ts = glfwGetTime();
+    // From server to clients
+    using P = std::pair<double, double>;
+    std::optional<P> minMax = nm.sync(NetworkManager::SyncMode::SendDataToClients);
+    if (minMax) {
+        _statistics.loopTimeMin.add(minMax->first);
+        _statistics.loopTimeMax.add(minMax->second);
+    }
+    if (nm.isComputerServer()) {
+        _statistics.syncTimes.add(static_cast<float>(glfwGetTime() - ts));
+    }
+
+    // Run only on clients
+    if (nm.isComputerServer() && !ClusterManager::instance().ignoreSync()) {
+        return;
+    }
+
+    // Not server
+    const double t0 = glfwGetTime();
+    Barrier.wait(
+        1,
+        [&nm]() { return !nm.isRunning() || nm.isSyncComplete(); },
+        [&nm](int) { return nm.syncConnection(0).isUpdated(); },
+        [this, &nm](double waitTime) {
+            const Network& c = nm.syncConnection(0);
+            if (_settings.printSyncMessage && !c.isUpdated()) {
+                Log::Info(std::format(
+                    "Waiting for master. frame send {} != recv {}\n\tSwap groups: {}"
+                    "\n\tSwap barrier: {}\n\tUniversal frame number: {}\n\t"
+                    "SGCT frame number: {}",
+                    c.sendFrameCurrent(), c.recvFramePrevious(),
+                    Window::isUsingSwapGroups() ? "enabled" : "disabled",
+                    Window::isBarrierActive() ? "enabled" : "disabled",
+                    Window::swapGroupFrameNumber(), _frameCounter
+                ));
+            }
+
+            if (waitTime > _settings.syncTimeout) {
+                throw Err(
+                    3004,
+                    std::format(
+                        "No sync signal from master for {} s", _settings.syncTimeout
+                    )
+                );
+            }
+        }
+    );
+
+    // A this point all data needed for rendering a frame is received.
+    // Let's signal that back to the master/server
+    nm.sync(NetworkManager::SyncMode::Acknowledge);
+    if (!nm.isComputerServer()) {
+        _statistics.syncTimes.add(glfwGetTime() - t0);
+    }
+}
+
+void Engine::frameLockPostStage() {
+    ZoneScoped;
+
+    const NetworkManager& nm = NetworkManager::instance();
+    // Post stage
+    if (ClusterManager::instance().ignoreSync() || !nm.isComputerServer()) {
+        return;
+    }
+
+    const double t0 = glfwGetTime();
+    Barrier.wait(
+        nm.syncConnectionsCount(),
+        [&nm]() {
+            return !nm.isRunning() || nm.activeConnectionsCount() == 0 ||
+                nm.isSyncComplete();
+        },
+        [&nm](int i) { return nm.connection(i).isUpdated(); },
+        [this, &nm](double waitTime) {
+            for (int i = 0; i < nm.syncConnectionsCount(); i++) {
+                if (_settings.printSyncMessage && !nm.connection(i).isUpdated()) {
+                    Log::Info(std::format(
+                        "Waiting for IG {}: send frame {} != recv frame {}\n\t"
+                        "Swap groups: {}\n\tSwap barrier: {}\n\t"
+                        "Universal frame number: {}\n\tSGCT frame number: {}",
+                        i, nm.connection(i).sendFrameCurrent(),
+                        nm.connection(i).recvFrameCurrent(),
+                        Window::isUsingSwapGroups() ? "enabled" : "disabled",
+                        Window::isBarrierActive() ? "enabled" : "disabled",
+                        Window::swapGroupFrameNumber(), _frameCounter
+                    ));
+                }
+            }
+
+            if (waitTime > _settings.syncTimeout) {
+                throw Err(
+                    3005,
+                    std::format(
+                        "No sync signal from clients for {} s", _settings.syncTimeout
+                    )
+                );
+            }
+        }
+    );
+
+    _statistics.syncTimes.add(glfwGetTime() - t0);
+}
+
+void Engine::exec() {
+    Window::makeSharedContextCurrent();
+
+    DrawTimeQueries drawTimeQueries;
+    glCreateQueries(GL_TIMESTAMP, DrawTimeQueries::Count, drawTimeQueries.begin.data());
+    glCreateQueries(GL_TIMESTAMP, DrawTimeQueries::Count, drawTimeQueries.end.data());
+
+    Node& thisNode = ClusterManager::instance().thisNode();
+    const std::vector<std::unique_ptr<Window>>& wins = thisNode.windows();
+    bool isMeasuringDrawTime = false;
+    while (!_shouldTerminate && !thisNode.closeAllWindows() &&
+           NetworkManager::instance().isRunning()) [[unlikely]]
+    {
+#ifdef SGCT_HAS_VRPN
+        if (isMaster()) {
+            TrackingManager::instance().updateTrackingDevices();
+        }
+#endif // SGCT_HAS_VRPN
+
+        {
+            ZoneScopedN("GLFW Poll Events");
+            glfwPollEvents();
+        }
+
+        Window::makeSharedContextCurrent();
+
+        if (_preSyncFn) [[likely]] {
+            ZoneScopedN("[SGCT] PreSync");
+            _preSyncFn();
+        }
+
+        if (NetworkManager::instance().isComputerServer()) {
+            SharedData::instance().encode();
+        }
+        else if (!NetworkManager::instance().isRunning()) {
+            // Exit if not running
+            Log::Error("Network disconnected. Exiting");
+            break;
+        }
+
+        frameLockPreStage();
+        std::for_each(wins.cbegin(), wins.cend(), std::mem_fn(&Window::update));
+        Window::makeSharedContextCurrent();
+
+        if (_postSyncPreDrawFn) [[likely]] {
+            ZoneScopedN("[SGCT] PostSyncPreDraw");
+            _postSyncPreDrawFn();
+        }
+
+        {
+            ZoneScopedN("Statistics update");
+            const double startFrameTime = glfwGetTime();
+            const double ft = static_cast<float>(startFrameTime - _statsPrevTimestamp);
+            _statistics.frametimes.add(ft);
+            _statsPrevTimestamp = startFrameTime;
+
+            // The renderer can be shown during the frame, which must not end a
+            // measurement that was never started
+            isMeasuringDrawTime = _statisticsRenderer != nullptr;
+            if (isMeasuringDrawTime) [[unlikely]] {
+                const int q = drawTimeQueries.next;
+                glQueryCounter(drawTimeQueries.begin[q], GL_TIMESTAMP);
+            }
+        }
+
+        // Render Viewports / Draw
+        std::for_each(wins.cbegin(), wins.cend(), std::mem_fn(&Window::draw));
+        std::for_each(wins.cbegin(), wins.cend(), std::mem_fn(&Window::renderFBOTexture));
+
+        Window::makeSharedContextCurrent();
+
+        if (isMeasuringDrawTime) [[unlikely]] {
+            ZoneScopedN("glQueryCounter");
+            const int q = drawTimeQueries.next;
+            glQueryCounter(drawTimeQueries.end[q], GL_TIMESTAMP);
+            drawTimeQueries.isPending[q] = true;
+            drawTimeQueries.next = (q + 1) % DrawTimeQueries::Count;
+        }
+
+        if (_postDrawFn) [[likely]] {
+            ZoneScopedN("[SGCT] PostDraw");
+            _postDrawFn();
+        }
+
+        if (!SharedMemoryOutputs.empty()) [[unlikely]] {
+            ZoneScopedN("Shared memory output");
+            try {
+                publishSharedMemoryOutputs(_frameCounter);
+            }
+            catch (const Error& e) {
+                Log::Error(std::format("Stopping shared memory output: {}", e.what()));
+                SharedMemoryOutputs.clear();
+            }
+        }
+
+        {
+            ZoneScopedN("Statistics Update");
+            collectDrawTimes(drawTimeQueries, _statistics.drawTimes);
+            if (_statisticsRenderer) [[unlikely]] {
+                _statisticsRenderer->update();
+                _captureStatisticsRenderer->update();
+            }
+        }
+
+        // Master will wait for nodes render before swapping
+        frameLockPostStage();
+        // Swap front and back rendering buffers
+        for (const std::unique_ptr<Window>& window : wins) {
+            bool shouldTakeScreenshot = _shouldTakeScreenshot;
+
+            // The window might want to opt out of taking screenshots
+            shouldTakeScreenshot &= window->shouldTakeScreenshot();
+
+            // If we don't want to take any screenshots anyway, there is no need for any
+            // extra work. Same thing if we want to take a screenshot of all windows,
+            // meaning that the _takeScreenshotIds list is empty
+            if (shouldTakeScreenshot && !_shouldTakeScreenshotIds.empty()) {
+                auto it = std::find(
+                    _shouldTakeScreenshotIds.cbegin(),
+                    _shouldTakeScreenshotIds.cend(),
+                    window->id()
+                );
+                // If the window id is in the list of ids, then we want to take a
+                // screenshot. We already checked that `shouldTakeScreenshot` is true in
+                // the if statement above
+                shouldTakeScreenshot = (it != _shouldTakeScreenshotIds.cend());
+            }
+            // Both eyes are read before the swap and the window does not capture them
+            // again
+            const bool fromBackBuffer = _settings.captureBackBuffer;
+            if (shouldTakeScreenshot && captureStereo(*window, fromBackBuffer)) {
+                shouldTakeScreenshot = false;
+            }
+            window->swapBuffers(shouldTakeScreenshot);
+        }
+        // Screenshot readbacks from previous frames that have arrived are written now
+        ScreenCapture::processPendingReadbacks(_statistics);
+
+        TracyGpuCollect;
+        FrameMark;
+
+        std::for_each(
+            wins.cbegin(),
+            wins.cend(),
+            std::mem_fn(&Window::updateResolutions)
+        );
+
+        // For all windows
+        _frameCounter++;
+        if (_shouldTakeScreenshot) {
+            _shotCounter++;
+        }
+        _shouldTakeScreenshot = false;
+    }
+
+    Window::makeSharedContextCurrent();
+    glDeleteQueries(DrawTimeQueries::Count, drawTimeQueries.begin.data());
+    glDeleteQueries(DrawTimeQueries::Count, drawTimeQueries.end.data());
+}
+
+bool Engine::isMaster() const {
+    return NetworkManager::instance().isComputerServer();
+}
+
+unsigned int Engine::currentFrameNumber() const {
+    return _frameCounter;
+}
+
+void Engine::waitForAllWindowsInSwapGroupToOpen() {
+    ZoneScoped;
+
+    ClusterManager& cm = ClusterManager::instance();
+    Node& thisNode = cm.thisNode();
+
+    // Clear the buffers initially
+    for (const std::unique_ptr<Window>& window : thisNode.windows()) {
+        ZoneScopedN("Clear Windows");
+        window->makeOpenGLContextCurrent();
+        glDrawBuffer(GL_BACK);
+        glClearColor(0.f, 0.f, 0.f, 0.f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        {
+            ZoneScopedN("glfwSwapBuffers");
+            glfwSwapBuffers(window->windowHandle());
+        }
+    }
+
+    {
+        ZoneScopedN("GLFW Poll Events");
+        glfwPollEvents();
+    }
+
+    // Must wait until all nodes are running if using swap barrier
+    if (cm.ignoreSync() || cm.numberOfNodes() == 1) {
+        return;
+    }
+
+    // Check if swapgroups are supported
+#ifdef WIN32
+    const bool hasSwapGroup = glfwExtensionSupported("WGL_NV_swap_group") == GLFW_TRUE;
+    Log::Info(
+        hasSwapGroup ?
+        "Swap groups are supported by hardware" :
+        "Swap groups are not supported by hardware"
+    );
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    Log::Info("Swap groups are not supported by hardware");
+#endif // WIN32
+
+    Log::Info("Waiting for all nodes to connect");
+
+    while (!NetworkManager::instance().areAllNodesConnected()) {
+        // Swap front and back rendering buffers
+        for (const std::unique_ptr<Window>& window : thisNode.windows()) {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glfwSwapBuffers(window->windowHandle());
+        }
+        {
+            ZoneScopedN("GLFW Poll Events");
+            glfwPollEvents();
+        }
+
+        if (_shouldTerminate || !NetworkManager::instance().isRunning() ||
+            thisNode.closeAllWindows())
+        {
+            // We can't just exit as the client application might need the OpenGL state
+            // for some cleanup.  Instead, we are calling the terminate function which
+            // will cause the first `render` call to be bypassed and the cleanup should
+            // work as expected
+            terminate();
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+void Engine::updateFrustums() const {
+    ZoneScoped;
+
+    for (const std::unique_ptr<Window>& win : windows()) {
+        win->updateFrustums(_nearClipPlane, _farClipPlane);
+    }
+}
+
+const Engine::Statistics& Engine::statistics() const {
+    return _statistics;
+}
+
+float Engine::nearClipPlane() const {
+    return _nearClipPlane;
+}
+
+float Engine::farClipPlane() const {
+    return _farClipPlane;
+}
+
+void Engine::setNearAndFarClippingPlanes(float nearClippingPlane, float farClippingPlane)
+{
+    _nearClipPlane = nearClippingPlane;
+    _farClipPlane = farClippingPlane;
+    updateFrustums();
+}
+
+const Window* Engine::focusedWindow() const {
+    ZoneScoped;
+
+    const Node& thisNode = ClusterManager::instance().thisNode();
+    const std::vector<std::unique_ptr<Window>>& ws = thisNode.windows();
+    const auto it = std::find_if(ws.begin(), ws.end(), std::mem_fn(&Window::isFocused));
+    return it != ws.end() ? it->get() : nullptr;
+}
+
+void Engine::setStatsGraphVisibility(bool value) {
+    if (value && _statisticsRenderer == nullptr) {
+        _statisticsRenderer = std::make_unique<StatisticsRenderer>(_statistics);
+        _captureStatisticsRenderer =
+            std::make_unique<CaptureStatisticsRenderer>(_statistics);
+        _captureStatisticsRenderer->setScale(_statisticsRenderer->scale());
+        _captureStatisticsRenderer->setOffset(_statisticsRenderer->offset());
+    }
+    if (!value && _statisticsRenderer) {
+        _statisticsRenderer = nullptr;
+        _captureStatisticsRenderer = nullptr;
+    }
+}
+
+float Engine::statsGraphScale() const {
+    return _statisticsRenderer ? _statisticsRenderer->scale() : -1.f;
+}
+
+void Engine::setStatsGraphScale(float scale) {
+    if (_statisticsRenderer) {
+        _statisticsRenderer->setScale(scale);
+        _captureStatisticsRenderer->setScale(scale);
+    }
+}
+
+vec2 Engine::statsGraphOffset() const {
+    return _statisticsRenderer ? _statisticsRenderer->offset() : vec2(-1.f, -1.f);
+}
+
+void Engine::setStatsGraphOffset(vec2 offset) {
+    if (_statisticsRenderer) {
+        _statisticsRenderer->setOffset(offset);
+        _captureStatisticsRenderer->setOffset(offset);
+    }
+}
+
+void Engine::takeScreenshot(std::vector<int> windowIds) {
+    _shouldTakeScreenshot = true;
+    _shouldTakeScreenshotIds = std::move(windowIds);
+}
+
+void Engine::resetScreenshotNumber() {
+    _shotCounter = 0;
+}
+
+Engine::DrawFunction Engine::drawFunction() const {
+    return _drawFn;
+}
+
+Engine::DrawFunction Engine::draw2DFunction() const {
+    return _draw2DFn;
+}
+
+const Node& Engine::thisNode() const {
+    return ClusterManager::instance().thisNode();
+}
+
+const std::vector<std::unique_ptr<Window>>& Engine::windows() const {
+    return ClusterManager::instance().thisNode().windows();
+}
+
+User& Engine::defaultUser() {
+    return ClusterManager::instance().defaultUser();
+}
+
+void Engine::setScreenshotNumber(unsigned int number) {
+    _shotCounter = number;
+}
+
+unsigned int Engine::screenShotNumber() const {
+    return _shotCounter;
+}
+
+void Engine::setCapturePath(std::filesystem::path path) {
+    _settings.capture.capturePath = std::move(path);
+    setScreenshotNumber(0);
+}
+
+void Engine::setCaptureFromBackBuffer(bool state) {
+    _settings.captureBackBuffer = state;
+}
+
+StatisticsRenderer* Engine::statisticsRenderer() {
+    return _statisticsRenderer.get();
+}
+
+CaptureStatisticsRenderer* Engine::captureStatisticsRenderer() {
+    return _captureStatisticsRenderer.get();
+}
+
+const Engine::Settings& Engine::settings() const {
+    return _settings;
+}
+
+
+} // namespace sgct
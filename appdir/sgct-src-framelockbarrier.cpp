@@ -0,0 +1,96 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/framelockbarrier.h>
+
+#include <sgct/engine.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <chrono>
+
+namespace sgct {
+
+namespace {
+    // The interval in seconds at which the onStall function is called
+    constexpr double StallInterval = 1.0;
+
+    FrameLockBarrier::Statistics BarrierStatistics;
+} // namespace
+
+const FrameLockBarrier::Statistics& FrameLockBarrier::statistics() {
+    return BarrierStatistics;
+}
+
+FrameLockBarrier::FrameLockBarrier(std::mutex& mutex, std::condition_variable& cond)
+    : _mutex(mutex)
+    , _cond(cond)
+{}
+
+void FrameLockBarrier::wait(int nNodes, const std::function<bool()>& isComplete,
+                            const std::function<bool(int)>& hasArrived,
+                            const std::function<void(double)>& onStall)
+{
+    ZoneScoped;
+
+    _latencies.assign(nNodes, -1.0);
+    const auto recordArrivals = [&](double latency) {
+        for (int i = 0; i < nNodes; i++) {
+            if (_latencies[i] < 0.0 && hasArrived(i)) {
+                _latencies[i] = latency;
+            }
+        }
+    };
+
+    const double t0 = time();
+    double nextStall = t0 + StallInterval;
+    int nWakeups = 0;
+    bool hasWaited = false;
+    const auto isDone = [&]() {
+        // Called before waiting and after every wakeup. The network threads update the
+        // arrivals and notify while holding the mutex, so no notification is missed
+        // between this check and going to sleep
+        if (hasWaited) {
+            recordArrivals(time() - t0);
+        }
+        const bool res = isComplete();
+        if (hasWaited && !res) {
+            nWakeups++;
+        }
+        hasWaited = true;
+        return res;
+    };
+
+    std::unique_lock lock(_mutex);
+    recordArrivals(0.0);
+    while (true) {
+        hasWaited = false;
+        const std::chrono::duration<double> remaining(std::max(nextStall - time(), 0.0));
+        if (_cond.wait_for(lock, remaining, isDone)) {
+            break;
+        }
+
+        const double t = time();
+        onStall(t - t0);
+        nextStall = t + StallInterval;
+    }
+    // Nodes that have not arrived because the wait ended when the network stopped are
+    // counted until now
+    const double elapsed = time() - t0;
+    lock.unlock();
+
+    Statistics& stats = BarrierStatistics;
+    if (stats.nodeLatencies.size() != static_cast<size_t>(nNodes)) {
+        stats.nodeLatencies.resize(nNodes);
+    }
+    for (int i = 0; i < nNodes; i++) {
+        stats.nodeLatencies[i].add(_latencies[i] < 0.0 ? elapsed : _latencies[i]);
+    }
+    stats.wakeups.add(static_cast<double>(nWakeups));
+}
+
+} // namespace sgct
@@ -8,20 +8,39 @@
 
 #include <sgct/image.h>
 
+#include <sgct/bufferpool.h>
+#include <sgct/capturepool.h>
 #include <sgct/engine.h>
 #include <sgct/error.h>
 #include <sgct/format.h>
 #include <sgct/log.h>
+#include <sgct/pixelconversion.h>
 #include <png.h>
 #include <zlib.h>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <csetjmp>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 
+#ifdef WIN32
+#include <Windows.h>
+#else // ^^^^ WIN32 // !WIN32 vvvv
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
 #ifdef WIN32
 #include <CodeAnalysis/warnings.h>
 #pragma warning(push)
@@ -44,7 +63,10 @@
 #endif // __clang__
 
 namespace {
+#if !defined(__x86_64__) && !defined(_M_X64)
+// SSE2 is only guaranteed on 64-bit x86, stb_image decodes JPEGs with it there
 #define STBI_NO_SIMD
+#endif // !defined(__x86_64__) && !defined(_M_X64)
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
@@ -67,10 +89,732 @@ namespace {
 
 namespace sgct {
 
-Image::~Image() {
-    if (_data) {
-        stbi_image_free(_data);
+namespace {
+    // Returns the size of the pixel data in bytes, which exceeds the range of an int for
+    // large images with 16 or 32 bit channels, such as 16k by 16k pixels
+    size_t byteSize(ivec2 size, int nChannels, int bytesPerChannel) {
+        return static_cast<size_t>(size.x) * static_cast<size_t>(size.y) *
+            static_cast<size_t>(nChannels) * static_cast<size_t>(bytesPerChannel);
+    }
+
+    // Strips with fewer rows are not worth the overhead of another worker
+    constexpr int MinRowsPerStrip = 64;
+
+    struct Strip {
+        int beginRow = 0;
+        int endRow = 0;
+        std::vector<unsigned char> compressed;
+        uLong adler = 0;
+        uLong length = 0;
+        int error = Z_OK;
+    };
+
+    // Writes the PNG filter type byte followed by the filtered \p current row to \p dst.
+    // \p previous is the row above in the PNG, or zeros for the first row
+    void filterRow(Image::PngFilter filter, const unsigned char* current,
+                   const unsigned char* previous, unsigned char* dst, size_t rowSize,
+                   size_t pixelSize)
+    {
+        switch (filter) {
+            case Image::PngFilter::None:
+                dst[0] = PNG_FILTER_VALUE_NONE;
+                std::memcpy(dst + 1, current, rowSize);
+                break;
+            case Image::PngFilter::Sub:
+                dst[0] = PNG_FILTER_VALUE_SUB;
+                std::memcpy(dst + 1, current, pixelSize);
+                for (size_t i = pixelSize; i < rowSize; i++) {
+                    const int diff = current[i] - current[i - pixelSize];
+                    dst[i + 1] = static_cast<unsigned char>(diff);
+                }
+                break;
+            case Image::PngFilter::Up:
+                dst[0] = PNG_FILTER_VALUE_UP;
+                for (size_t i = 0; i < rowSize; i++) {
+                    dst[i + 1] = static_cast<unsigned char>(current[i] - previous[i]);
+                }
+                break;
+            default:
+                throw std::logic_error("Unhandled case label");
+        }
+    }
+
+    // Compresses the rows [beginRow, endRow) of the PNG image (top to bottom) into a raw
+    // deflate stream. Every row is converted from bottom-up BGR(A) with little-endian
+    // channels to the PNG layout, filtered, and prefixed with the filter byte. All but
+    // the last strip are terminated with a sync flush so that the strips can be
+    // concatenated
+    void compressStrip(Strip& strip, const unsigned char* data, ivec2 size, int nChannels,
+                       int bytesPerChannel, int level, Image::PngFilter filter,
+                       bool isLast)
+    {
+        const size_t rowSize = static_cast<size_t>(size.x) * nChannels * bytesPerChannel;
+        const size_t pixelSize = static_cast<size_t>(nChannels) * bytesPerChannel;
+        std::vector<unsigned char> row(rowSize + 1);
+        std::vector<unsigned char> current(rowSize);
+        std::vector<unsigned char> previous(rowSize, 0);
+        auto convertRow = [&](int r, unsigned char* dst) {
+            const size_t y = static_cast<size_t>(size.y) - 1 - static_cast<size_t>(r);
+            pixelconversion::convertToPngLayout(
+                data + y * rowSize,
+                dst,
+                size.x,
+                nChannels,
+                bytesPerChannel
+            );
+        };
+        if (filter == Image::PngFilter::Up && strip.beginRow > 0) {
+            // The first row of the strip is filtered against the last row of the strip
+            // above
+            convertRow(strip.beginRow - 1, previous.data());
+        }
+
+        z_stream stream = {};
+        strip.error = deflateInit2(
+            &stream,
+            level,
+            Z_DEFLATED,
+            -15,
+            8,
+            Z_DEFAULT_STRATEGY
+        );
+        if (strip.error != Z_OK) {
+            return;
+        }
+
+        const uLong nRows = static_cast<uLong>(strip.endRow - strip.beginRow);
+        strip.length = nRows * static_cast<uLong>(row.size());
+        // The additional bytes are for the sync flush marker
+        strip.compressed.resize(deflateBound(&stream, strip.length) + 16);
+        stream.next_out = strip.compressed.data();
+        stream.avail_out = static_cast<uInt>(strip.compressed.size());
+
+        strip.adler = adler32(0, nullptr, 0);
+        for (int r = strip.beginRow; r < strip.endRow; r++) {
+            if (filter == Image::PngFilter::None) {
+                // Convert directly into the output row to save a copy
+                row[0] = PNG_FILTER_VALUE_NONE;
+                convertRow(r, row.data() + 1);
+            }
+            else {
+                convertRow(r, current.data());
+                filterRow(
+                    filter,
+                    current.data(),
+                    previous.data(),
+                    row.data(),
+                    rowSize,
+                    pixelSize
+                );
+                std::swap(current, previous);
+            }
+
+            strip.adler = adler32(strip.adler, row.data(), static_cast<uInt>(row.size()));
+            stream.next_in = row.data();
+            stream.avail_in = static_cast<uInt>(row.size());
+            const bool isLastRow = r == strip.endRow - 1;
+            const int flush =
+                isLastRow ? (isLast ? Z_FINISH : Z_SYNC_FLUSH) : Z_NO_FLUSH;
+            const int res = deflate(&stream, flush);
+            if (res != Z_OK && res != Z_STREAM_END) {
+                strip.error = res;
+                break;
+            }
+        }
+        strip.compressed.resize(strip.compressed.size() - stream.avail_out);
+        deflateEnd(&stream);
+    }
+
+    void appendChunk(std::vector<unsigned char>& buffer, const char* type,
+                     const unsigned char* data, size_t length)
+    {
+        const std::array<unsigned char, 4> len = {
+            static_cast<unsigned char>((length >> 24) & 0xFF),
+            static_cast<unsigned char>((length >> 16) & 0xFF),
+            static_cast<unsigned char>((length >> 8) & 0xFF),
+            static_cast<unsigned char>(length & 0xFF)
+        };
+        buffer.insert(buffer.end(), len.begin(), len.end());
+        buffer.insert(buffer.end(), type, type + 4);
+        uLong crc = crc32(0, reinterpret_cast<const Bytef*>(type), 4);
+        if (length > 0) {
+            buffer.insert(buffer.end(), data, data + length);
+            crc = crc32(crc, data, static_cast<uInt>(length));
+        }
+        const std::array<unsigned char, 4> c = {
+            static_cast<unsigned char>((crc >> 24) & 0xFF),
+            static_cast<unsigned char>((crc >> 16) & 0xFF),
+            static_cast<unsigned char>((crc >> 8) & 0xFF),
+            static_cast<unsigned char>(crc & 0xFF)
+        };
+        buffer.insert(buffer.end(), c.begin(), c.end());
+    }
+
+    // Output function for libpng that appends the encoded data to the vector that was
+    // passed as the io pointer
+    void appendPngData(png_structp png, png_bytep data, png_size_t length) {
+        auto* buffer = static_cast<std::vector<unsigned char>*>(png_get_io_ptr(png));
+        buffer->insert(buffer->end(), data, data + length);
+    }
+
+    void flushPngData(png_structp) {}
+
+    struct PngSource {
+        const unsigned char* data = nullptr;
+        size_t length = 0;
+        size_t position = 0;
+    };
+
+    void readPngData(png_structp png, png_bytep data, png_size_t length) {
+        auto* source = static_cast<PngSource*>(png_get_io_ptr(png));
+        if (source->position + length > source->length) {
+            png_error(png, "Unexpected end of PNG data");
+        }
+        std::memcpy(data, source->data + source->position, length);
+        source->position += length;
+    }
+
+    // Decodes the PNG directly into the layout that SGCT uses, as 8-bit BGR(A) with
+    // the rows bottom-up, so that the image needs neither a flip nor a channel swap
+    // afterwards. Like stb_image, palettes and transparency are expanded, 16-bit
+    // channels are reduced to their high byte, and the gamma is ignored. Returns
+    // `false` if the data is not a valid PNG
+    bool decodePng(const unsigned char* data, size_t length, Image& image) {
+        png_structp png = png_create_read_struct(
+            PNG_LIBPNG_VER_STRING,
+            nullptr,
+            nullptr,
+            nullptr
+        );
+        if (!png) {
+            return false;
+        }
+        png_infop info = png_create_info_struct(png);
+        if (!info) {
+            png_destroy_read_struct(&png, nullptr, nullptr);
+            return false;
+        }
+
+        // Everything that has to be cleaned up after a longjmp is created before it
+        PngSource source = { data, length, 0 };
+        std::vector<png_bytep> rows;
+        if (setjmp(png_jmpbuf(png))) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            return false;
+        }
+        png_set_read_fn(png, &source, readPngData);
+        png_read_info(png, info);
+
+        const int colorType = png_get_color_type(png, info);
+        if (colorType == PNG_COLOR_TYPE_PALETTE) {
+            png_set_palette_to_rgb(png);
+        }
+        if (colorType == PNG_COLOR_TYPE_GRAY && png_get_bit_depth(png, info) < 8) {
+            png_set_expand_gray_1_2_4_to_8(png);
+        }
+        if (png_get_valid(png, info, PNG_INFO_tRNS)) {
+            png_set_tRNS_to_alpha(png);
+        }
+        png_set_strip_16(png);
+        png_set_bgr(png);
+        png_set_interlace_handling(png);
+        png_read_update_info(png, info);
+
+        const ivec2 size = ivec2{
+            static_cast<int>(png_get_image_width(png, info)),
+            static_cast<int>(png_get_image_height(png, info))
+        };
+        image.setSize(size);
+        image.setChannels(png_get_channels(png, info));
+        image.setBytesPerChannel(1);
+        image.setFloatingPoint(false);
+        image.allocateOrResizeData();
+
+        const size_t rowSize = png_get_rowbytes(png, info);
+        rows.resize(size.y);
+        for (int y = 0; y < size.y; y++) {
+            rows[y] = image.data() + static_cast<size_t>(size.y - 1 - y) * rowSize;
+        }
+        png_read_image(png, rows.data());
+        png_destroy_read_struct(&png, &info, nullptr);
+        return true;
+    }
+
+    bool isPng(const unsigned char* data, size_t length) {
+        constexpr std::array<unsigned char, 8> Signature = {
+            137, 80, 78, 71, 13, 10, 26, 10
+        };
+        return length >= Signature.size() &&
+            std::memcmp(data, Signature.data(), Signature.size()) == 0;
+    }
+
+    // A read-only view of a whole file, which saves the copy into a buffer and lets the
+    // operating system read ahead while the image is decoded
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path& path) {
+            const std::string p = path.string();
+            auto error = [&p]() {
+                return Err(
+                    9001,
+                    std::format("Could not open file '{}' for loading image", p)
+                );
+            };
+            std::error_code ec;
+            _size = std::filesystem::file_size(path, ec);
+            if (ec || _size == 0) {
+                throw error();
+            }
+#ifdef WIN32
+            _file = CreateFileA(
+                p.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                nullptr
+            );
+            if (_file == INVALID_HANDLE_VALUE) {
+                throw error();
+            }
+            _fileMapping =
+                CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (_fileMapping) {
+                _data = reinterpret_cast<const unsigned char*>(
+                    MapViewOfFile(_fileMapping, FILE_MAP_READ, 0, 0, 0)
+                );
+            }
+            if (!_data) {
+                if (_fileMapping) {
+                    CloseHandle(_fileMapping);
+                }
+                CloseHandle(_file);
+                throw error();
+            }
+#else // ^^^^ WIN32 // !WIN32 vvvv
+            const int file = open(p.c_str(), O_RDONLY);
+            if (file == -1) {
+                throw error();
+            }
+            void* m = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+            close(file);
+            if (m == MAP_FAILED) {
+                throw error();
+            }
+            madvise(m, _size, MADV_WILLNEED);
+            _data = reinterpret_cast<const unsigned char*>(m);
+#endif // WIN32
+        }
+
+        ~MappedFile() {
+#ifdef WIN32
+            UnmapViewOfFile(_data);
+            CloseHandle(_fileMapping);
+            CloseHandle(_file);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+            munmap(const_cast<unsigned char*>(_data), _size);
+#endif // WIN32
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const unsigned char* data() const { return _data; }
+        size_t size() const { return static_cast<size_t>(_size); }
+
+    private:
+        const unsigned char* _data = nullptr;
+        uintmax_t _size = 0;
+#ifdef WIN32
+        HANDLE _file = nullptr;
+        HANDLE _fileMapping = nullptr;
+#endif // WIN32
+    };
+
+    void writeUInt32(unsigned char* dst, uint32_t v) {
+        dst[0] = static_cast<unsigned char>((v >> 24) & 0xFF);
+        dst[1] = static_cast<unsigned char>((v >> 16) & 0xFF);
+        dst[2] = static_cast<unsigned char>((v >> 8) & 0xFF);
+        dst[3] = static_cast<unsigned char>(v & 0xFF);
+    }
+
+    uint32_t readUInt32(const unsigned char* src) {
+        return
+            (static_cast<uint32_t>(src[0]) << 24) | (static_cast<uint32_t>(src[1]) << 16) |
+            (static_cast<uint32_t>(src[2]) << 8) | static_cast<uint32_t>(src[3]);
     }
+
+    // The "Quite OK Image Format" (https://qoiformat.org) is a lossless format that is
+    // an order of magnitude faster to encode than PNG at a slightly larger file size
+    constexpr unsigned char QoiOpIndex = 0x00;
+    constexpr unsigned char QoiOpDiff = 0x40;
+    constexpr unsigned char QoiOpLuma = 0x80;
+    constexpr unsigned char QoiOpRun = 0xC0;
+    constexpr unsigned char QoiOpRgb = 0xFE;
+    constexpr unsigned char QoiOpRgba = 0xFF;
+    constexpr unsigned char QoiMask = 0xC0;
+    constexpr size_t QoiHeaderSize = 14;
+    constexpr std::array<unsigned char, 8> QoiPadding = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+    struct QoiPixel {
+        unsigned char r = 0;
+        unsigned char g = 0;
+        unsigned char b = 0;
+        unsigned char a = 255;
+
+        bool operator==(const QoiPixel& rhs) const {
+            return r == rhs.r && g == rhs.g && b == rhs.b && a == rhs.a;
+        }
+    };
+
+    int qoiHash(const QoiPixel& p) {
+        return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+    }
+
+    // Encodes bottom-up BGR(A) data into a QOI image with top-down RGB(A) pixels
+    std::vector<unsigned char> qoiEncode(const unsigned char* data, ivec2 size,
+                                         int nChannels)
+    {
+        const size_t nPixels = static_cast<size_t>(size.x) * size.y;
+        std::vector<unsigned char> res(
+            QoiHeaderSize + nPixels * (nChannels + 1) + QoiPadding.size()
+        );
+        unsigned char* out = res.data();
+
+        std::memcpy(out, "qoif", 4);
+        writeUInt32(out + 4, static_cast<uint32_t>(size.x));
+        writeUInt32(out + 8, static_cast<uint32_t>(size.y));
+        out[12] = static_cast<unsigned char>(nChannels);
+        out[13] = 0; // sRGB with linear alpha
+        out += QoiHeaderSize;
+
+        std::array<QoiPixel, 64> index = {};
+        QoiPixel prev;
+        int run = 0;
+        const size_t rowSize = static_cast<size_t>(size.x) * nChannels;
+        for (int y = size.y - 1; y >= 0; y--) {
+            const unsigned char* row = data + static_cast<size_t>(y) * rowSize;
+            for (int x = 0; x < size.x; x++) {
+                const unsigned char* src = row + static_cast<size_t>(x) * nChannels;
+                QoiPixel px;
+                px.b = src[0];
+                px.g = src[1];
+                px.r = src[2];
+                if (nChannels == 4) {
+                    px.a = src[3];
+                }
+
+                if (px == prev) {
+                    run++;
+                    if (run == 62) {
+                        *out++ = static_cast<unsigned char>(QoiOpRun | (run - 1));
+                        run = 0;
+                    }
+                    continue;
+                }
+
+                if (run > 0) {
+                    *out++ = static_cast<unsigned char>(QoiOpRun | (run - 1));
+                    run = 0;
+                }
+
+                const int h = qoiHash(px);
+                if (index[h] == px) {
+                    *out++ = static_cast<unsigned char>(QoiOpIndex | h);
+                }
+                else {
+                    index[h] = px;
+
+                    if (px.a == prev.a) {
+                        const signed char vr = static_cast<signed char>(px.r - prev.r);
+                        const signed char vg = static_cast<signed char>(px.g - prev.g);
+                        const signed char vb = static_cast<signed char>(px.b - prev.b);
+                        const signed char vgr = static_cast<signed char>(vr - vg);
+                        const signed char vgb = static_cast<signed char>(vb - vg);
+
+                        if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                            *out++ = static_cast<unsigned char>(
+                                QoiOpDiff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)
+                            );
+                        }
+                        else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 &&
+                                 vgb > -9 && vgb < 8)
+                        {
+                            *out++ = static_cast<unsigned char>(QoiOpLuma | (vg + 32));
+                            *out++ = static_cast<unsigned char>((vgr + 8) << 4 | (vgb + 8));
+                        }
+                        else {
+                            *out++ = QoiOpRgb;
+                            *out++ = px.r;
+                            *out++ = px.g;
+                            *out++ = px.b;
+                        }
+                    }
+                    else {
+                        *out++ = QoiOpRgba;
+                        *out++ = px.r;
+                        *out++ = px.g;
+                        *out++ = px.b;
+                        *out++ = px.a;
+                    }
+                }
+                prev = px;
+            }
+        }
+        if (run > 0) {
+            *out++ = static_cast<unsigned char>(QoiOpRun | (run - 1));
+        }
+        std::memcpy(out, QoiPadding.data(), QoiPadding.size());
+        out += QoiPadding.size();
+
+        res.resize(out - res.data());
+        return res;
+    }
+
+    // Decodes a QOI image into bottom-up BGR(A) data. The returned memory is allocated
+    // with malloc as it is owned by an Image
+    unsigned char* qoiDecode(const unsigned char* data, size_t length, ivec2& size,
+                             int& nChannels)
+    {
+        if (length < QoiHeaderSize + QoiPadding.size() ||
+            std::memcmp(data, "qoif", 4) != 0)
+        {
+            return nullptr;
+        }
+        size.x = static_cast<int>(readUInt32(data + 4));
+        size.y = static_cast<int>(readUInt32(data + 8));
+        nChannels = data[12];
+        if (size.x <= 0 || size.y <= 0 || (nChannels != 3 && nChannels != 4)) {
+            return nullptr;
+        }
+
+        const size_t rowSize = static_cast<size_t>(size.x) * nChannels;
+        unsigned char* res = reinterpret_cast<unsigned char*>(
+            std::malloc(rowSize * size.y)
+        );
+        if (!res) {
+            return nullptr;
+        }
+
+        std::array<QoiPixel, 64> index = {};
+        QoiPixel px;
+        int run = 0;
+        size_t p = QoiHeaderSize;
+        const size_t end = length - QoiPadding.size();
+        for (int y = size.y - 1; y >= 0; y--) {
+            unsigned char* row = res + static_cast<size_t>(y) * rowSize;
+            for (int x = 0; x < size.x; x++) {
+                if (run > 0) {
+                    run--;
+                }
+                else if (p < end) {
+                    const unsigned char b1 = data[p++];
+                    if (b1 == QoiOpRgb) {
+                        px.r = data[p++];
+                        px.g = data[p++];
+                        px.b = data[p++];
+                    }
+                    else if (b1 == QoiOpRgba) {
+                        px.r = data[p++];
+                        px.g = data[p++];
+                        px.b = data[p++];
+                        px.a = data[p++];
+                    }
+                    else if ((b1 & QoiMask) == QoiOpIndex) {
+                        px = index[b1];
+                    }
+                    else if ((b1 & QoiMask) == QoiOpDiff) {
+                        px.r = static_cast<unsigned char>(px.r + ((b1 >> 4) & 0x03) - 2);
+                        px.g = static_cast<unsigned char>(px.g + ((b1 >> 2) & 0x03) - 2);
+                        px.b = static_cast<unsigned char>(px.b + (b1 & 0x03) - 2);
+                    }
+                    else if ((b1 & QoiMask) == QoiOpLuma) {
+                        const unsigned char b2 = data[p++];
+                        const int vg = (b1 & 0x3F) - 32;
+                        px.r = static_cast<unsigned char>(px.r + vg - 8 + ((b2 >> 4) & 0x0F));
+                        px.g = static_cast<unsigned char>(px.g + vg);
+                        px.b = static_cast<unsigned char>(px.b + vg - 8 + (b2 & 0x0F));
+                    }
+                    else if ((b1 & QoiMask) == QoiOpRun) {
+                        run = b1 & 0x3F;
+                    }
+                    index[qoiHash(px)] = px;
+                }
+
+                unsigned char* dst = row + static_cast<size_t>(x) * nChannels;
+                dst[0] = px.b;
+                dst[1] = px.g;
+                dst[2] = px.r;
+                if (nChannels == 4) {
+                    dst[3] = px.a;
+                }
+            }
+        }
+        return res;
+    }
+
+    // Number of scanlines that are compressed together in EXR files with ZIP compression
+    constexpr int ExrLinesPerBlock = 16;
+
+    template <typename T>
+    void appendBytes(std::vector<unsigned char>& buffer, T value) {
+        // EXR files are little-endian like all platforms that SGCT runs on
+        const size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        std::memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    void appendString(std::vector<unsigned char>& buffer, std::string_view str) {
+        buffer.insert(buffer.end(), str.begin(), str.end());
+        buffer.push_back(0);
+    }
+
+    void appendAttribute(std::vector<unsigned char>& header, std::string_view name,
+                         std::string_view type, const std::vector<unsigned char>& value)
+    {
+        appendString(header, name);
+        appendString(header, type);
+        appendBytes(header, static_cast<int32_t>(value.size()));
+        header.insert(header.end(), value.begin(), value.end());
+    }
+
+    struct ExrChannel {
+        std::string_view name;
+        /// The index of the channel in the interleaved BGR(A) pixels of the image
+        int index = 0;
+    };
+
+    // EXR stores the channels sorted by their name
+    std::vector<ExrChannel> exrChannels(int nChannels) {
+        switch (nChannels) {
+            case 1: return { { "Y", 0 } };
+            case 2: return { { "A", 1 }, { "Y", 0 } };
+            case 3: return { { "B", 0 }, { "G", 1 }, { "R", 2 } };
+            case 4: return { { "A", 3 }, { "B", 0 }, { "G", 1 }, { "R", 2 } };
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }
+
+    std::vector<unsigned char> exrHeader(ivec2 size, const std::vector<ExrChannel>& chans,
+                                         int bytesPerChannel)
+    {
+        // Magic number and version 2 for a single-part scanline file
+        std::vector<unsigned char> header = { 0x76, 0x2f, 0x31, 0x01, 2, 0, 0, 0 };
+
+        std::vector<unsigned char> channels;
+        for (const ExrChannel& c : chans) {
+            appendString(channels, c.name);
+            // The pixel type is 1 (HALF) or 2 (FLOAT)
+            appendBytes(channels, static_cast<int32_t>(bytesPerChannel == 2 ? 1 : 2));
+            // pLinear and three reserved bytes
+            appendBytes(channels, static_cast<int32_t>(0));
+            // The sampling in x and y
+            appendBytes(channels, static_cast<int32_t>(1));
+            appendBytes(channels, static_cast<int32_t>(1));
+        }
+        channels.push_back(0);
+        appendAttribute(header, "channels", "chlist", channels);
+
+        // ZIP compression with blocks of 16 scanlines
+        appendAttribute(header, "compression", "compression", { 3 });
+
+        std::vector<unsigned char> window;
+        appendBytes(window, static_cast<int32_t>(0));
+        appendBytes(window, static_cast<int32_t>(0));
+        appendBytes(window, static_cast<int32_t>(size.x - 1));
+        appendBytes(window, static_cast<int32_t>(size.y - 1));
+        appendAttribute(header, "dataWindow", "box2i", window);
+        appendAttribute(header, "displayWindow", "box2i", window);
+
+        // Increasing y, the first scanline in the file is the top row
+        appendAttribute(header, "lineOrder", "lineOrder", { 0 });
+
+        std::vector<unsigned char> one;
+        appendBytes(one, 1.f);
+        appendAttribute(header, "pixelAspectRatio", "float", one);
+        const std::vector<unsigned char> center(2 * sizeof(float), 0);
+        appendAttribute(header, "screenWindowCenter", "v2f", center);
+        appendAttribute(header, "screenWindowWidth", "float", one);
+
+        header.push_back(0);
+        return header;
+    }
+
+    template <typename T>
+    void gatherChannel(const unsigned char* row, int width, int nChannels, int index,
+                       unsigned char* dst)
+    {
+        const T* src = reinterpret_cast<const T*>(row) + index;
+        for (int x = 0; x < width; x++) {
+            std::memcpy(dst + x * sizeof(T), src + x * nChannels, sizeof(T));
+        }
+    }
+
+    struct ExrBlock {
+        std::vector<unsigned char> data;
+        int error = Z_OK;
+    };
+
+    // Converts the scanlines of block `iBlock` (counted from the top) from bottom-up
+    // interleaved BGR(A) into the planar layout of EXR files and compresses them the same
+    // way as the ZIP compression of OpenEXR: the bytes are split into two halves, delta
+    // encoded, and then deflated. Blocks that do not get smaller are stored uncompressed
+    void compressExrBlock(ExrBlock& block, int iBlock, const unsigned char* data,
+                          ivec2 size, const std::vector<ExrChannel>& channels,
+                          int bytesPerChannel, int level)
+    {
+        const int nChannels = static_cast<int>(channels.size());
+        const size_t rowSize = static_cast<size_t>(size.x) * nChannels * bytesPerChannel;
+        const size_t planeSize = static_cast<size_t>(size.x) * bytesPerChannel;
+        const int firstLine = iBlock * ExrLinesPerBlock;
+        const int nLines = std::min(ExrLinesPerBlock, size.y - firstLine);
+
+        std::vector<unsigned char> planar(rowSize * nLines);
+        for (int l = 0; l < nLines; l++) {
+            const unsigned char* row = data + (size.y - 1 - firstLine - l) * rowSize;
+            for (int c = 0; c < nChannels; c++) {
+                unsigned char* dst = planar.data() + l * rowSize + c * planeSize;
+                const int index = channels[c].index;
+                if (bytesPerChannel == 2) {
+                    gatherChannel<uint16_t>(row, size.x, nChannels, index, dst);
+                }
+                else {
+                    gatherChannel<uint32_t>(row, size.x, nChannels, index, dst);
+                }
+            }
+        }
+
+        std::vector<unsigned char> predicted(planar.size());
+        const size_t half = (planar.size() + 1) / 2;
+        for (size_t i = 0; i < planar.size(); i++) {
+            predicted[(i % 2 == 0) ? i / 2 : half + i / 2] = planar[i];
+        }
+        unsigned char previous = predicted[0];
+        for (size_t i = 1; i < predicted.size(); i++) {
+            const unsigned char current = predicted[i];
+            predicted[i] = static_cast<unsigned char>(current - previous + (128 + 256));
+            previous = current;
+        }
+
+        uLongf length = compressBound(static_cast<uLong>(predicted.size()));
+        block.data.resize(length);
+        block.error = compress2(
+            block.data.data(),
+            &length,
+            predicted.data(),
+            static_cast<uLong>(predicted.size()),
+            level
+        );
+        block.data.resize(length);
+        if (block.error == Z_OK && length >= planar.size()) {
+            block.data = std::move(planar);
+        }
+    }
+} // namespace
+
+Image::~Image() {
+    freeData();
 }
 
 void Image::load(const std::filesystem::path& filename) {
@@ -78,39 +822,138 @@ void Image::load(const std::filesystem::path& filename) {
         throw Err(9000, "Cannot load empty filepath");
     }
 
-    stbi_set_flip_vertically_on_load(1);
-    std::string name = filename.string();
-    _data = stbi_load(name.c_str(), &_size.x, &_size.y, &_nChannels, 0);
-    if (_data == nullptr) {
+    const MappedFile file(filename);
+    if (!decode(file.data(), file.size())) {
         throw Err(
-            9001, std::format("Could not open file '{}' for loading image", name));
+            9001, std::format("Could not open file '{}' for loading image", filename)
+        );
     }
-    _bytesPerChannel = 1;
-    _dataSize = _size.x * _size.y * _nChannels * _bytesPerChannel;
+}
 
-    // Convert BGR to RGB
-    if (_nChannels >= 3) {
-        for (size_t i = 0; i < _dataSize; i += _nChannels) {
-            std::swap(_data[i], _data[i + 2]);
+void Image::load(unsigned char* data, int length) {
+    decode(data, static_cast<size_t>(std::max(length, 0)));
+}
+
+std::vector<std::unique_ptr<Image>> Image::loadBatch(
+    const std::vector<std::filesystem::path>& filenames, int nThreads)
+{
+    const double t0 = time();
+
+    if (nThreads <= 0) {
+        nThreads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    }
+    nThreads = std::min(nThreads, static_cast<int>(filenames.size()));
+
+    // The threads take the next file as soon as they are done, so that a few large
+    // images do not hold up the rest
+    std::vector<std::unique_ptr<Image>> images(filenames.size());
+    std::atomic<size_t> next = 0;
+    std::atomic<int> nFailed = 0;
+    auto worker = [&]() {
+        for (size_t i = next++; i < filenames.size(); i = next++) {
+            const double t = time();
+            try {
+                auto image = std::make_unique<Image>();
+                image->load(filenames[i]);
+                Log::Debug(std::format(
+                    "Loaded '{}' ({}x{}, {} channels) in {:.2f} ms",
+                    filenames[i], image->size().x, image->size().y, image->channels(),
+                    (time() - t) * 1000.0
+                ));
+                images[i] = std::move(image);
+            }
+            catch (const std::runtime_error& e) {
+                Log::Error(e.what());
+                nFailed++;
+            }
         }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(std::max(nThreads - 1, 0));
+    for (int i = 1; i < nThreads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
     }
-}
 
-void Image::load(unsigned char* data, int length) {
-    stbi_set_flip_vertically_on_load(1);
-    _data = stbi_load_from_memory(data, length, &_size.x, &_size.y, &_nChannels, 0);
-    _bytesPerChannel = 1;
-    _dataSize = _size.x * _size.y * _nChannels * _bytesPerChannel;
+    Log::Info(std::format(
+        "Loaded {} of {} images on {} threads in {:.2f} ms",
+        filenames.size() - nFailed, filenames.size(), nThreads, (time() - t0) * 1000.0
+    ));
+    return images;
+}
 
-    // Convert BGR to RGB
-    if (_nChannels >= 3) {
-        for (size_t i = 0; i < _dataSize; i += _nChannels) {
-            std::swap(_data[i], _data[i + 2]);
+bool Image::decode(const unsigned char* data, size_t length) {
+    freeData();
+    if (length >= 4 && std::memcmp(data, "qoif", 4) == 0) {
+        _data = qoiDecode(data, length, _size, _nChannels);
+        _isDataBorrowed = false;
+        _isFloat = false;
+        if (_data == nullptr) {
+            throw Err(9015, "Invalid QOI image");
         }
+        _bytesPerChannel = 1;
+        _dataSize = byteSize(_size, _nChannels, _bytesPerChannel);
+        return true;
+    }
+
+    if (isPng(data, length)) {
+        return decodePng(data, length, *this);
+    }
+
+    // stb_image takes the length as an int, which is no limit for the other formats
+    _data = stbi_load_from_memory(
+        data,
+        static_cast<int>(std::min<size_t>(length, std::numeric_limits<int>::max())),
+        &_size.x,
+        &_size.y,
+        &_nChannels,
+        0
+    );
+    _isDataBorrowed = false;
+    _isFloat = false;
+    _bytesPerChannel = 1;
+    _dataSize = byteSize(_size, _nChannels, _bytesPerChannel);
+    if (!_data) {
+        return false;
     }
+
+    // Flip the image and convert RGB to BGR in one pass instead of letting stb_image
+    // do the flip
+    pixelconversion::flipAndSwapRedBlue(_data, _size, _nChannels);
+    return true;
 }
 
 void Image::save(const std::filesystem::path& filename) {
+    const double t0 = time();
+
+    // The image is encoded completely before the file is created, so that the file is
+    // written with a single call
+    writeFile(filename, encode(filename));
+
+    const double t = (time() - t0) * 1000.0;
+    Log::Debug(std::format("'{}' was saved successfully ({:.2f} ms)", filename, t));
+}
+
+void Image::writeFile(const std::filesystem::path& filename,
+                      const std::vector<unsigned char>& data)
+{
+    std::string f = filename.string();
+    FILE* fp = fopen(f.c_str(), "wb");
+    if (fp == nullptr) {
+        throw Err(9008, std::format("Cannot create image file '{}'", f));
+    }
+    const size_t nWritten = fwrite(data.data(), 1, data.size(), fp);
+    fclose(fp);
+    if (nWritten != data.size()) {
+        throw Err(9014, std::format("Error writing image file '{}'", f));
+    }
+}
+
+std::vector<unsigned char> Image::encode(const std::filesystem::path& filename) const {
     if (filename.empty()) {
         throw Err(9002, "Filename not set for saving image");
     }
@@ -121,16 +964,28 @@ void Image::save(const std::filesystem::path& filename) {
         throw Err(9006, "Missing image data to save PNG");
     }
 
+    if (filename.extension() == ".exr") {
+        return encodeExr(filename);
+    }
+
+    if (_isFloat) {
+        throw Err(
+            9018,
+            std::format("Floating-point image '{}' can only be saved as EXR", filename)
+        );
+    }
+
+    if (filename.extension() == ".qoi") {
+        return encodeQoi();
+    }
+
     if (_bytesPerChannel > 2) {
         throw Err(9007, std::format("Cannot save {} bit", _bytesPerChannel * 8));
     }
 
-    const double t0 = time();
-
-    std::string f = filename.string();
-    FILE* fp = fopen(f.c_str(), "wb");
-    if (fp == nullptr) {
-        throw Err(9008, std::format("Cannot create PNG file '{}'", f));
+    const int nStrips = std::min(_nEncoderThreads, _size.y / MinRowsPerStrip);
+    if (nStrips > 1 && _encoderPool) {
+        return encodeParallelPng(nStrips);
     }
 
     // Initialize stuff
@@ -144,13 +999,16 @@ void Image::save(const std::filesystem::path& filename) {
         throw Err(9009, "Failed to create PNG struct");
     }
 
-    // Compression levels 1-9.
-    //   -1 = Default compression
-    //    0 = No compression
-    //    1 = Best speed
-    //    9 = Best compression
-    png_set_compression_level(png, 1);
-    png_set_filter(png, 0, PNG_FILTER_NONE);
+    png_set_compression_level(png, _pngCompressionLevel);
+    const int filter = [](PngFilter f) {
+        switch (f) {
+            case PngFilter::None: return PNG_FILTER_NONE;
+            case PngFilter::Sub: return PNG_FILTER_SUB;
+            case PngFilter::Up: return PNG_FILTER_UP;
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }(_pngFilter);
+    png_set_filter(png, 0, filter);
     png_set_compression_mem_level(png, 8);
     png_set_compression_strategy(png, Z_DEFAULT_STRATEGY);
     png_set_compression_window_bits(png, 15);
@@ -162,12 +1020,16 @@ void Image::save(const std::filesystem::path& filename) {
         throw Err(9010, "Failed to create PNG info struct");
     }
 
+    // Declared before the setjmp so that the jump does not skip its destruction
+    std::vector<unsigned char> buffer;
+    buffer.reserve(_dataSize / 2);
+
     if (setjmp(png_jmpbuf(png))) {
         png_destroy_write_struct(&png, &info);
         throw Err(9011, "One of the called PNG functions failed");
     }
 
-    png_init_io(png, fp);
+    png_set_write_fn(png, &buffer, appendPngData, flushPngData);
 
     const int colorType = [](int channels) {
         switch (channels) {
@@ -192,30 +1054,200 @@ void Image::save(const std::filesystem::path& filename) {
         PNG_FILTER_TYPE_BASE
     );
 
-    if (colorType == PNG_COLOR_TYPE_RGB || colorType == PNG_COLOR_TYPE_RGB_ALPHA) {
-        png_set_bgr(png);
-    }
     png_write_info(png, info);
 
-    // Swap big-endian to little endian
-    if (_bytesPerChannel == 2) {
-        png_set_swap(png);
-    }
-
-    std::vector<png_bytep> rowPtrs(_size.y);
-    for (int y = 0; y < _size.y; y++) {
-        const size_t idx = static_cast<size_t>(_size.y) - 1 - static_cast<size_t>(y);
-        rowPtrs[idx] = &_data[y * _size.x * _nChannels * _bytesPerChannel];
+    // The rows are written bottom-up to flip the image and each row is converted to
+    // big-endian RGB(A) with the SIMD kernels instead of libpng's transformations
+    const size_t rowSize =
+        static_cast<size_t>(_size.x) * _nChannels * _bytesPerChannel;
+    std::vector<unsigned char> row(rowSize);
+    for (int y = _size.y - 1; y >= 0; y--) {
+        pixelconversion::convertToPngLayout(
+            _data + y * rowSize,
+            row.data(),
+            _size.x,
+            _nChannels,
+            _bytesPerChannel
+        );
+        png_write_row(png, row.data());
     }
-    png_write_image(png, rowPtrs.data());
-    rowPtrs.clear();
 
     png_write_end(png, nullptr);
     png_destroy_write_struct(&png, &info);
-    fclose(fp);
+    return buffer;
+}
 
-    const double t = (time() - t0) * 1000.0;
-    Log::Debug(std::format("'{}' was saved successfully ({:.2f} ms)", filename, t));
+std::vector<unsigned char> Image::encodeQoi() const {
+    if (_bytesPerChannel != 1 || (_nChannels != 3 && _nChannels != 4)) {
+        throw Err(
+            9016,
+            std::format(
+                "Cannot save {} bit with {} channels as QOI",
+                _bytesPerChannel * 8, _nChannels
+            )
+        );
+    }
+    return qoiEncode(_data, _size, _nChannels);
+}
+
+std::vector<unsigned char> Image::encodeParallelPng(int nStrips) const {
+    const int colorType = [](int channels) {
+        switch (channels) {
+            case 1: return PNG_COLOR_TYPE_GRAY;
+            case 2: return PNG_COLOR_TYPE_GRAY_ALPHA;
+            case 3: return PNG_COLOR_TYPE_RGB;
+            case 4: return PNG_COLOR_TYPE_RGB_ALPHA;
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }(_nChannels);
+
+    // Compress the strips concurrently on this thread and the idle workers of the pool
+    std::vector<Strip> strips(nStrips);
+    for (int i = 0; i < nStrips; i++) {
+        const int64_t height = _size.y;
+        strips[i].beginRow = static_cast<int>(height * i / nStrips);
+        strips[i].endRow = static_cast<int>(height * (i + 1) / nStrips);
+    }
+    _encoderPool->runInParallel(
+        nStrips,
+        [&](int i) {
+            compressStrip(
+                strips[i], _data, _size, _nChannels, _bytesPerChannel,
+                _pngCompressionLevel, _pngFilter, i == nStrips - 1
+            );
+        }
+    );
+
+    uLong adler = strips[0].adler;
+    for (const Strip& strip : strips) {
+        if (strip.error != Z_OK && strip.error != Z_STREAM_END) {
+            throw Err(9013, std::format("Failed to compress PNG data ({})", strip.error));
+        }
+        if (&strip != &strips.front()) {
+            const z_off_t length = static_cast<z_off_t>(strip.length);
+            adler = adler32_combine(adler, strip.adler, length);
+        }
+    }
+
+    size_t size = 0;
+    for (const Strip& strip : strips) {
+        size += strip.compressed.size() + 12;
+    }
+    std::vector<unsigned char> buffer;
+    buffer.reserve(size + 64);
+
+    constexpr std::array<unsigned char, 8> Signature = {
+        137, 80, 78, 71, 13, 10, 26, 10
+    };
+    buffer.insert(buffer.end(), Signature.begin(), Signature.end());
+
+    std::array<unsigned char, 13> header = {};
+    writeUInt32(&header[0], static_cast<uint32_t>(_size.x));
+    writeUInt32(&header[4], static_cast<uint32_t>(_size.y));
+    header[8] = static_cast<unsigned char>(_bytesPerChannel * 8);
+    header[9] = static_cast<unsigned char>(colorType);
+    header[10] = PNG_COMPRESSION_TYPE_BASE;
+    header[11] = PNG_FILTER_TYPE_BASE;
+    header[12] = PNG_INTERLACE_NONE;
+    appendChunk(buffer, "IHDR", header.data(), header.size());
+
+    // The zlib stream is split across the IDAT chunks: the zlib header (32K window and
+    // the compression level) goes before the first strip and the checksum of the
+    // uncompressed data after the last one
+    const int levelFlag = [](int level) {
+        if (level <= 1) {
+            return 0;
+        }
+        else if (level <= 5) {
+            return 1;
+        }
+        else if (level == 6) {
+            return 2;
+        }
+        else {
+            return 3;
+        }
+    }(_pngCompressionLevel) << 6;
+    // The header as a 16-bit number has to be a multiple of 31
+    const std::array<unsigned char, 2> zlibHeader = {
+        0x78,
+        static_cast<unsigned char>(levelFlag + 31 - (0x7800 + levelFlag) % 31)
+    };
+    std::vector<unsigned char>& first = strips.front().compressed;
+    first.insert(first.begin(), zlibHeader.begin(), zlibHeader.end());
+    std::vector<unsigned char>& last = strips.back().compressed;
+    last.resize(last.size() + 4);
+    writeUInt32(last.data() + last.size() - 4, static_cast<uint32_t>(adler));
+
+    for (const Strip& strip : strips) {
+        appendChunk(buffer, "IDAT", strip.compressed.data(), strip.compressed.size());
+    }
+    appendChunk(buffer, "IEND", nullptr, 0);
+    return buffer;
+}
+
+std::vector<unsigned char> Image::encodeExr(const std::filesystem::path& filename) const {
+    if (!_isFloat || (_bytesPerChannel != 2 && _bytesPerChannel != 4)) {
+        throw Err(
+            9017,
+            std::format(
+                "Cannot save {} bit integer image '{}' as EXR",
+                _bytesPerChannel * 8, filename
+            )
+        );
+    }
+
+    const std::vector<ExrChannel> channels = exrChannels(_nChannels);
+    const std::vector<unsigned char> header =
+        exrHeader(_size, channels, _bytesPerChannel);
+
+    // The blocks are compressed concurrently in contiguous ranges on this thread and the
+    // idle workers of the pool
+    const int nBlocks = (_size.y + ExrLinesPerBlock - 1) / ExrLinesPerBlock;
+    std::vector<ExrBlock> blocks(nBlocks);
+    const int nRanges = _encoderPool ? std::clamp(_nEncoderThreads, 1, nBlocks) : 1;
+    auto compressRange = [&](int range) {
+        const int end = nBlocks * (range + 1) / nRanges;
+        for (int i = nBlocks * range / nRanges; i < end; i++) {
+            compressExrBlock(
+                blocks[i], i, _data, _size, channels, _bytesPerChannel,
+                _pngCompressionLevel
+            );
+        }
+    };
+    if (nRanges > 1) {
+        _encoderPool->runInParallel(nRanges, compressRange);
+    }
+    else {
+        compressRange(0);
+    }
+
+    for (const ExrBlock& block : blocks) {
+        if (block.error != Z_OK) {
+            throw Err(9019, std::format("Failed to compress EXR data ({})", block.error));
+        }
+    }
+
+    // The offset table points to the beginning of each block in the file
+    std::vector<uint64_t> offsets(nBlocks);
+    uint64_t offset = header.size() + offsets.size() * sizeof(uint64_t);
+    for (int i = 0; i < nBlocks; i++) {
+        offsets[i] = offset;
+        offset += 2 * sizeof(int32_t) + blocks[i].data.size();
+    }
+
+    std::vector<unsigned char> buffer;
+    buffer.reserve(offset);
+    buffer.insert(buffer.end(), header.begin(), header.end());
+    for (uint64_t o : offsets) {
+        appendBytes(buffer, o);
+    }
+    for (int i = 0; i < nBlocks; i++) {
+        appendBytes(buffer, static_cast<int32_t>(i * ExrLinesPerBlock));
+        appendBytes(buffer, static_cast<int32_t>(blocks[i].data.size()));
+        buffer.insert(buffer.end(), blocks[i].data.begin(), blocks[i].data.end());
+    }
+    return buffer;
 }
 
 unsigned char* Image::data() {
@@ -234,6 +1266,10 @@ int Image::bytesPerChannel() const {
     return _bytesPerChannel;
 }
 
+bool Image::isFloatingPoint() const {
+    return _isFloat;
+}
+
 ivec2 Image::size() const {
     return _size;
 }
@@ -250,10 +1286,30 @@ void Image::setBytesPerChannel(int bpc) {
     _bytesPerChannel = bpc;
 }
 
+void Image::setFloatingPoint(bool isFloat) {
+    _isFloat = isFloat;
+}
+
+void Image::setEncoderThreads(int nThreads) {
+    _nEncoderThreads = std::max(nThreads, 1);
+}
+
+void Image::setEncoderPool(CapturePool* pool) {
+    _encoderPool = pool;
+}
+
+void Image::setPngCompressionLevel(int level) {
+    _pngCompressionLevel = std::clamp(level, 0, 9);
+}
+
+void Image::setPngFilter(PngFilter filter) {
+    _pngFilter = filter;
+}
+
 void Image::allocateOrResizeData() {
     const double t0 = time();
 
-    const unsigned int dataSize = _nChannels * _size.x * _size.y * _bytesPerChannel;
+    const size_t dataSize = byteSize(_size, _nChannels, _bytesPerChannel);
     if (dataSize == 0) {
         throw Err(
             9012,
@@ -264,16 +1320,16 @@ void Image::allocateOrResizeData() {
         );
     }
 
-    if (_data && _dataSize != dataSize) {
-        // Reallocate if needed
-        delete[] _data;
-        _data = nullptr;
-        _dataSize = 0;
+    if (_isDataBorrowed || _dataSize != dataSize) {
+        // Replace the view onto someone else's memory with our own or reallocate if
+        // needed. A buffer of a similar size comes back from the pool right away
+        freeData();
     }
 
     if (!_data) {
-        _data = new unsigned char[dataSize];
+        _data = BufferPool::instance().acquire(dataSize);
         _dataSize = dataSize;
+        _isDataPooled = true;
 
         Log::Debug(std::format(
             "Allocated {} bytes for image data ({:.2f} ms)",
@@ -282,4 +1338,27 @@ void Image::allocateOrResizeData() {
     }
 }
 
+void Image::setBorrowedData(unsigned char* data) {
+    freeData();
+    _data = data;
+    _dataSize = byteSize(_size, _nChannels, _bytesPerChannel);
+    _isDataBorrowed = true;
+}
+
+void Image::freeData() {
+    if (_data && !_isDataBorrowed) {
+        if (_isDataPooled) {
+            BufferPool::instance().release(_data);
+        }
+        else {
+            // Loaded images are allocated by stb_image or the QOI decoder with malloc
+            stbi_image_free(_data);
+        }
+    }
+    _data = nullptr;
+    _dataSize = 0;
+    _isDataBorrowed = false;
+    _isDataPooled = false;
+}
+
 } // namespace sgct
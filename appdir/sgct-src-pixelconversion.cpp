@@ -0,0 +1,531 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/pixelconversion.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SGCT_PIXELCONVERSION_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC allows AVX2 intrinsics in any function
+#define SGCT_TARGET_AVX2
+#else // ^^^^ _MSC_VER // !_MSC_VER vvvv
+#define SGCT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif // _MSC_VER
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define SGCT_PIXELCONVERSION_NEON
+#include <arm_neon.h>
+#endif // defined(__x86_64__) || defined(_M_X64)
+
+namespace sgct::pixelconversion {
+
+namespace {
+    // The position in the source pixel of each byte of a destination pixel for the PNG
+    // layout. Pixels have at most 4 channels with 2 bytes each
+    struct Permutation {
+        std::array<unsigned char, 8> index = {};
+        size_t pixelSize = 0;
+        bool isIdentity = true;
+    };
+
+    Permutation pngPermutation(int nChannels, int bytesPerChannel) {
+        Permutation p;
+        p.pixelSize = static_cast<size_t>(nChannels) * bytesPerChannel;
+        for (int c = 0; c < nChannels; c++) {
+            int srcChannel = c;
+            if (nChannels >= 3 && c == 0) {
+                srcChannel = 2;
+            }
+            else if (nChannels >= 3 && c == 2) {
+                srcChannel = 0;
+            }
+            for (int b = 0; b < bytesPerChannel; b++) {
+                const int srcByte = bytesPerChannel - 1 - b;
+                const int i = c * bytesPerChannel + b;
+                p.index[i] = static_cast<unsigned char>(
+                    srcChannel * bytesPerChannel + srcByte
+                );
+                p.isIdentity &= p.index[i] == i;
+            }
+        }
+        return p;
+    }
+
+    template <int NChannels, int BytesPerChannel>
+    void convertScalar(const unsigned char* src, unsigned char* dst, size_t nPixels) {
+        // With the layout known at compile time, the compiler resolves all indices
+        constexpr size_t PixelSize = NChannels * BytesPerChannel;
+        std::array<unsigned char, PixelSize> pixel;
+        for (size_t i = 0; i < nPixels * PixelSize; i += PixelSize) {
+            std::memcpy(pixel.data(), src + i, PixelSize);
+            for (int c = 0; c < NChannels; c++) {
+                int srcChannel = c;
+                if (NChannels >= 3 && c == 0) {
+                    srcChannel = 2;
+                }
+                else if (NChannels >= 3 && c == 2) {
+                    srcChannel = 0;
+                }
+                for (int b = 0; b < BytesPerChannel; b++) {
+                    dst[i + c * BytesPerChannel + b] =
+                        pixel[srcChannel * BytesPerChannel + BytesPerChannel - 1 - b];
+                }
+            }
+        }
+    }
+
+    void convertScalar(const unsigned char* src, unsigned char* dst, size_t nPixels,
+                       int nChannels, int bytesPerChannel)
+    {
+        switch (nChannels * 10 + bytesPerChannel) {
+            case 11: std::memcpy(dst, src, nPixels); break;
+            case 12: convertScalar<1, 2>(src, dst, nPixels); break;
+            case 21: std::memcpy(dst, src, nPixels * 2); break;
+            case 22: convertScalar<2, 2>(src, dst, nPixels); break;
+            case 31: convertScalar<3, 1>(src, dst, nPixels); break;
+            case 32: convertScalar<3, 2>(src, dst, nPixels); break;
+            case 41: convertScalar<4, 1>(src, dst, nPixels); break;
+            case 42: convertScalar<4, 2>(src, dst, nPixels); break;
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }
+
+#ifdef SGCT_PIXELCONVERSION_X86
+    bool hasAvx2() {
+        static const bool HasAvx2 = []() {
+#ifdef _MSC_VER
+            std::array<int, 4> info;
+            __cpuid(info.data(), 0);
+            if (info[0] < 7) {
+                return false;
+            }
+            // The operating system has to save the AVX registers on context switches
+            __cpuid(info.data(), 1);
+            const bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+            if (!hasOsxsave || (_xgetbv(0) & 0x6) != 0x6) {
+                return false;
+            }
+            __cpuidex(info.data(), 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else // ^^^^ _MSC_VER // !_MSC_VER vvvv
+            return __builtin_cpu_supports("avx2") != 0;
+#endif // _MSC_VER
+        }();
+        return HasAvx2;
+    }
+
+    // Applies the permutation to as many whole pixels as fit into 16 bytes, for two such
+    // groups at a time. The bytes after the last whole pixel in each 16 byte store are
+    // overwritten by the next store. Returns the number of converted pixels
+    SGCT_TARGET_AVX2 size_t convertAvx2(const unsigned char* src, unsigned char* dst,
+                                        size_t nPixels, const Permutation& p)
+    {
+        const size_t pixelsPerLane = 16 / p.pixelSize;
+        const size_t step = pixelsPerLane * p.pixelSize;
+        alignas(16) std::array<unsigned char, 16> mask;
+        for (size_t i = 0; i < mask.size(); i++) {
+            const size_t pixelStart = i - i % p.pixelSize;
+            mask[i] = static_cast<unsigned char>(
+                i < step ? pixelStart + p.index[i % p.pixelSize] : i
+            );
+        }
+        const __m256i m = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(mask.data()))
+        );
+
+        const size_t size = nPixels * p.pixelSize;
+        size_t i = 0;
+        for (; i + step + 16 <= size; i += 2 * step) {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i hi = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src + i + step)
+            );
+            const __m256i v = _mm256_shuffle_epi8(_mm256_set_m128i(hi, lo), m);
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(dst + i),
+                _mm256_castsi256_si128(v)
+            );
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(dst + i + step),
+                _mm256_extracti128_si256(v, 1)
+            );
+        }
+        return i / p.pixelSize;
+    }
+
+    // Only the pixel layouts that can be converted with shifts and word shuffles are
+    // handled, as SSE2 has no byte shuffle. Returns the number of converted pixels
+    size_t convertSse2(const unsigned char* src, unsigned char* dst, size_t nPixels,
+                       int nChannels, int bytesPerChannel)
+    {
+        const size_t size = nPixels * nChannels * bytesPerChannel;
+        size_t i = 0;
+        if (nChannels == 4 && bytesPerChannel == 1) {
+            // Blue and red are in the bytes 0 and 2 of each 32-bit pixel
+            const __m128i rbMask = _mm_set1_epi32(0x00FF00FF);
+            for (; i + 16 <= size; i += 16) {
+                const __m128i v = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + i)
+                );
+                const __m128i rb = _mm_and_si128(v, rbMask);
+                const __m128i ga = _mm_andnot_si128(rbMask, v);
+                const __m128i swapped = _mm_or_si128(
+                    _mm_slli_epi32(rb, 16),
+                    _mm_srli_epi32(rb, 16)
+                );
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(dst + i),
+                    _mm_or_si128(ga, swapped)
+                );
+            }
+        }
+        else if (bytesPerChannel == 2 && nChannels != 3) {
+            for (; i + 16 <= size; i += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+                if (nChannels == 4) {
+                    // Swap the words 0 and 2 of each 64-bit pixel
+                    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 1, 2));
+                    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 0, 1, 2));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+            }
+        }
+        return i / (static_cast<size_t>(nChannels) * bytesPerChannel);
+    }
+#endif // SGCT_PIXELCONVERSION_X86
+
+#ifdef SGCT_PIXELCONVERSION_NEON
+    // Returns the number of converted pixels
+    size_t convertNeon(const unsigned char* src, unsigned char* dst, size_t nPixels,
+                       int nChannels, int bytesPerChannel)
+    {
+        size_t i = 0;
+        if (bytesPerChannel == 1 && nChannels == 3) {
+            for (; i + 16 <= nPixels; i += 16) {
+                uint8x16x3_t v = vld3q_u8(src + i * 3);
+                std::swap(v.val[0], v.val[2]);
+                vst3q_u8(dst + i * 3, v);
+            }
+        }
+        else if (bytesPerChannel == 1 && nChannels == 4) {
+            for (; i + 16 <= nPixels; i += 16) {
+                uint8x16x4_t v = vld4q_u8(src + i * 4);
+                std::swap(v.val[0], v.val[2]);
+                vst4q_u8(dst + i * 4, v);
+            }
+        }
+        else if (bytesPerChannel == 2 && nChannels == 3) {
+            const uint16_t* s = reinterpret_cast<const uint16_t*>(src);
+            uint16_t* d = reinterpret_cast<uint16_t*>(dst);
+            for (; i + 8 <= nPixels; i += 8) {
+                uint16x8x3_t v = vld3q_u16(s + i * 3);
+                std::swap(v.val[0], v.val[2]);
+                for (uint16x8_t& c : v.val) {
+                    c = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(c)));
+                }
+                vst3q_u16(d + i * 3, v);
+            }
+        }
+        else if (bytesPerChannel == 2 && nChannels == 4) {
+            const uint16_t* s = reinterpret_cast<const uint16_t*>(src);
+            uint16_t* d = reinterpret_cast<uint16_t*>(dst);
+            for (; i + 8 <= nPixels; i += 8) {
+                uint16x8x4_t v = vld4q_u16(s + i * 4);
+                std::swap(v.val[0], v.val[2]);
+                for (uint16x8_t& c : v.val) {
+                    c = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(c)));
+                }
+                vst4q_u16(d + i * 4, v);
+            }
+        }
+        else if (bytesPerChannel == 2) {
+            const size_t size = nPixels * nChannels * 2;
+            size_t b = 0;
+            for (; b + 16 <= size; b += 16) {
+                vst1q_u8(dst + b, vrev16q_u8(vld1q_u8(src + b)));
+            }
+            i = b / (static_cast<size_t>(nChannels) * 2);
+        }
+        return i;
+    }
+#endif // SGCT_PIXELCONVERSION_NEON
+
+    // Converts between two distinct memory regions
+    void convert(const unsigned char* src, unsigned char* dst, size_t nPixels,
+                 const Permutation& p, int nChannels, int bytesPerChannel)
+    {
+        if (p.isIdentity) {
+            std::memcpy(dst, src, nPixels * p.pixelSize);
+            return;
+        }
+
+        size_t nDone = 0;
+#ifdef SGCT_PIXELCONVERSION_X86
+        nDone =
+            hasAvx2() ?
+            convertAvx2(src, dst, nPixels, p) :
+            convertSse2(src, dst, nPixels, nChannels, bytesPerChannel);
+#elif defined(SGCT_PIXELCONVERSION_NEON)
+        nDone = convertNeon(src, dst, nPixels, nChannels, bytesPerChannel);
+#endif // SGCT_PIXELCONVERSION_X86
+
+        const size_t offset = nDone * p.pixelSize;
+        convertScalar(
+            src + offset,
+            dst + offset,
+            nPixels - nDone,
+            nChannels,
+            bytesPerChannel
+        );
+    }
+
+    // Converting in place goes through a buffer that stays in the L1 cache. Otherwise
+    // the overlapping stores of the AVX2 kernel for 3 and 6 byte pixels would stall the
+    // loads of the following pixels
+    constexpr size_t BufferSize = 4096;
+
+    void convertInPlace(unsigned char* data, size_t nPixels, int nChannels,
+                        int bytesPerChannel)
+    {
+        const Permutation p = pngPermutation(nChannels, bytesPerChannel);
+        if (p.isIdentity) {
+            return;
+        }
+
+        std::array<unsigned char, BufferSize> buffer;
+        const size_t pixelsPerChunk = buffer.size() / p.pixelSize;
+        for (size_t i = 0; i < nPixels; i += pixelsPerChunk) {
+            const size_t n = std::min(pixelsPerChunk, nPixels - i);
+            unsigned char* chunk = data + i * p.pixelSize;
+            convert(chunk, buffer.data(), n, p, nChannels, bytesPerChannel);
+            std::memcpy(chunk, buffer.data(), n * p.pixelSize);
+        }
+    }
+
+    // Adds the \p n bytes of \p src to the 16-bit \p sums
+    void accumulateRow(const unsigned char* src, uint16_t* sums, size_t n) {
+        size_t i = 0;
+#ifdef SGCT_PIXELCONVERSION_X86
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i* lo = reinterpret_cast<__m128i*>(sums + i);
+            __m128i* hi = reinterpret_cast<__m128i*>(sums + i + 8);
+            _mm_storeu_si128(
+                lo,
+                _mm_add_epi16(_mm_loadu_si128(lo), _mm_unpacklo_epi8(v, zero))
+            );
+            _mm_storeu_si128(
+                hi,
+                _mm_add_epi16(_mm_loadu_si128(hi), _mm_unpackhi_epi8(v, zero))
+            );
+        }
+#elif defined(SGCT_PIXELCONVERSION_NEON)
+        for (; i + 16 <= n; i += 16) {
+            const uint8x16_t v = vld1q_u8(src + i);
+            vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vget_low_u8(v)));
+            vst1q_u16(sums + i + 8, vaddw_u8(vld1q_u16(sums + i + 8), vget_high_u8(v)));
+        }
+#endif // SGCT_PIXELCONVERSION_X86
+        for (; i < n; i++) {
+            sums[i] = static_cast<uint16_t>(sums[i] + src[i]);
+        }
+    }
+
+    // Adds each pair of neighboring pixels of the \p nPixels pixels in \p sums and
+    // stores the results at the beginning of \p sums, which halves the width of the row
+    void halveRow(uint16_t* sums, size_t nPixels, int nChannels) {
+        const size_t n = nPixels / 2;
+        size_t i = 0;
+        if (nChannels == 4) {
+            // A pixel is 64 bits, so four input pixels in two registers become two
+            // output pixels. The output never overtakes the input, so this works in place
+#ifdef SGCT_PIXELCONVERSION_X86
+            for (; i + 2 <= n; i += 2) {
+                const __m128i a = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(sums + i * 8)
+                );
+                const __m128i b = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(sums + i * 8 + 8)
+                );
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(sums + i * 4),
+                    _mm_add_epi16(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b))
+                );
+            }
+#elif defined(SGCT_PIXELCONVERSION_NEON)
+            for (; i + 2 <= n; i += 2) {
+                const uint16x8_t a = vld1q_u16(sums + i * 8);
+                const uint16x8_t b = vld1q_u16(sums + i * 8 + 8);
+                vst1q_u16(
+                    sums + i * 4,
+                    vaddq_u16(
+                        vcombine_u16(vget_low_u16(a), vget_low_u16(b)),
+                        vcombine_u16(vget_high_u16(a), vget_high_u16(b))
+                    )
+                );
+            }
+#endif // SGCT_PIXELCONVERSION_X86
+        }
+        for (; i < n; i++) {
+            for (int c = 0; c < nChannels; c++) {
+                sums[i * nChannels + c] = static_cast<uint16_t>(
+                    sums[2 * i * nChannels + c] + sums[(2 * i + 1) * nChannels + c]
+                );
+            }
+        }
+    }
+
+    // Divides the \p n \p sums by 2^shift with rounding and stores them as bytes
+    void storeAverages(const uint16_t* sums, unsigned char* dst, size_t n, int shift) {
+        const uint16_t half = static_cast<uint16_t>(1 << (shift - 1));
+        size_t i = 0;
+#ifdef SGCT_PIXELCONVERSION_X86
+        const __m128i h = _mm_set1_epi16(static_cast<short>(half));
+        const __m128i count = _mm_cvtsi32_si128(shift);
+        for (; i + 16 <= n; i += 16) {
+            const __m128i lo = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(sums + i)
+            );
+            const __m128i hi = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(sums + i + 8)
+            );
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(dst + i),
+                _mm_packus_epi16(
+                    _mm_srl_epi16(_mm_add_epi16(lo, h), count),
+                    _mm_srl_epi16(_mm_add_epi16(hi, h), count)
+                )
+            );
+        }
+#elif defined(SGCT_PIXELCONVERSION_NEON)
+        // A rounding shift to the left by a negative amount is a shift to the right
+        const int16x8_t s = vdupq_n_s16(static_cast<int16_t>(-shift));
+        for (; i + 16 <= n; i += 16) {
+            const uint8x8_t lo = vmovn_u16(vrshlq_u16(vld1q_u16(sums + i), s));
+            const uint8x8_t hi = vmovn_u16(vrshlq_u16(vld1q_u16(sums + i + 8), s));
+            vst1q_u8(dst + i, vcombine_u8(lo, hi));
+        }
+#endif // SGCT_PIXELCONVERSION_X86
+        for (; i < n; i++) {
+            dst[i] = static_cast<unsigned char>((sums[i] + half) >> shift);
+        }
+    }
+} // namespace
+
+void swapRedBlue(unsigned char* data, size_t nPixels, int nChannels) {
+    convertInPlace(data, nPixels, nChannels, 1);
+}
+
+void convertToPngLayout(const unsigned char* src, unsigned char* dst, size_t nPixels,
+                        int nChannels, int bytesPerChannel)
+{
+    if (src == dst) {
+        convertInPlace(dst, nPixels, nChannels, bytesPerChannel);
+    }
+    else {
+        const Permutation p = pngPermutation(nChannels, bytesPerChannel);
+        convert(src, dst, nPixels, p, nChannels, bytesPerChannel);
+    }
+}
+
+void flipVertically(unsigned char* data, size_t rowSize, size_t nRows) {
+    // The copies through a small buffer are vectorized by the standard library and keep
+    // the buffer in the L1 cache
+    std::array<unsigned char, BufferSize> buffer;
+    for (size_t y = 0; y < nRows / 2; y++) {
+        unsigned char* top = data + y * rowSize;
+        unsigned char* bottom = data + (nRows - 1 - y) * rowSize;
+        for (size_t i = 0; i < rowSize; i += buffer.size()) {
+            const size_t n = std::min(buffer.size(), rowSize - i);
+            std::memcpy(buffer.data(), top + i, n);
+            std::memcpy(top + i, bottom + i, n);
+            std::memcpy(bottom + i, buffer.data(), n);
+        }
+    }
+}
+
+void flipAndSwapRedBlue(unsigned char* data, ivec2 size, int nChannels) {
+    const size_t width = static_cast<size_t>(size.x);
+    const size_t nRows = static_cast<size_t>(size.y);
+    const size_t rowSize = width * nChannels;
+    const Permutation p = pngPermutation(nChannels, 1);
+
+    // Each pair of rows is swapped and converted at the same time, one chunk at a time
+    std::array<unsigned char, BufferSize> buffer;
+    const size_t pixelsPerChunk = buffer.size() / nChannels;
+    for (size_t y = 0; y < nRows / 2; y++) {
+        unsigned char* top = data + y * rowSize;
+        unsigned char* bottom = data + (nRows - 1 - y) * rowSize;
+        for (size_t i = 0; i < width; i += pixelsPerChunk) {
+            const size_t n = std::min(pixelsPerChunk, width - i);
+            const size_t offset = i * nChannels;
+            convert(top + offset, buffer.data(), n, p, nChannels, 1);
+            convert(bottom + offset, top + offset, n, p, nChannels, 1);
+            std::memcpy(bottom + offset, buffer.data(), n * nChannels);
+        }
+    }
+    if (nRows % 2 == 1) {
+        convertInPlace(data + nRows / 2 * rowSize, width, nChannels, 1);
+    }
+}
+
+void downscale(const unsigned char* src, ivec2 size, int nChannels, int factor,
+               unsigned char* dst)
+{
+    int shift = 0;
+    switch (factor) {
+        case 2: shift = 2; break;
+        case 4: shift = 4; break;
+        case 8: shift = 6; break;
+        default: throw std::logic_error("Unhandled case label");
+    }
+
+    // The sums of a block are at most 64 * 255, which fits into 16 bits. Each row of the
+    // result is computed by adding the rows of the blocks into a buffer that stays in
+    // the cache and then adding neighboring pixels in the buffer until the blocks are
+    // reduced to single pixels
+    const size_t outWidth = static_cast<size_t>(size.x / factor);
+    const size_t outHeight = static_cast<size_t>(size.y / factor);
+    const size_t rowSize = static_cast<size_t>(size.x) * nChannels;
+    const size_t width = outWidth * factor;
+    std::vector<uint16_t> sums(width * nChannels);
+    for (size_t y = 0; y < outHeight; y++) {
+        std::fill(sums.begin(), sums.end(), uint16_t(0));
+        for (int r = 0; r < factor; r++) {
+            const unsigned char* row = src + (y * factor + r) * rowSize;
+            accumulateRow(row, sums.data(), sums.size());
+        }
+        for (size_t n = width; n > outWidth; n /= 2) {
+            halveRow(sums.data(), n, nChannels);
+        }
+        storeAverages(sums.data(), dst + y * outWidth * nChannels, outWidth * nChannels,
+            shift);
+    }
+}
+
+std::string_view instructionSet() {
+#ifdef SGCT_PIXELCONVERSION_X86
+    return hasAvx2() ? "AVX2" : "SSE2";
+#elif defined(SGCT_PIXELCONVERSION_NEON)
+    return "NEON";
+#else // ^^^^ SGCT_PIXELCONVERSION_NEON // !SGCT_PIXELCONVERSION_NEON vvvv
+    return "Scalar";
+#endif // SGCT_PIXELCONVERSION_X86
+}
+
+} // namespace sgct::pixelconversion
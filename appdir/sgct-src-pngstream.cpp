@@ -0,0 +1,244 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/pngstream.h>
+
+#include <sgct/engine.h>
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/image.h>
+#include <sgct/log.h>
+#include <sgct/pixelconversion.h>
+#include <sgct/profiling.h>
+#include <png.h>
+#include <csetjmp>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef WIN32
+#pragma warning(disable : 4611)
+#endif // WIN32
+
+#define Err(code, msg) Error(Error::Component::Image, code, msg)
+
+namespace sgct {
+
+PngStream::PngStream(std::filesystem::path filename, ivec2 size, int nChannels,
+                     int bytesPerChannel, int compressionLevel)
+    : _filename(std::move(filename))
+    , _size(std::move(size))
+    , _nChannels(nChannels)
+    , _bytesPerChannel(bytesPerChannel)
+    , _startTime(time())
+    , _row(static_cast<size_t>(_size.x) * nChannels * bytesPerChannel)
+{
+    ZoneScoped;
+
+    const int colorType = [](int channels) {
+        switch (channels) {
+            case 1: return PNG_COLOR_TYPE_GRAY;
+            case 2: return PNG_COLOR_TYPE_GRAY_ALPHA;
+            case 3: return PNG_COLOR_TYPE_RGB;
+            case 4: return PNG_COLOR_TYPE_RGB_ALPHA;
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }(_nChannels);
+
+    const std::string f = _filename.string();
+    _file = std::fopen(f.c_str(), "wb");
+    if (!_file) {
+        throw Err(9032, std::format("Cannot create PNG file '{}'", f));
+    }
+
+    png_structp png = png_create_write_struct(
+        PNG_LIBPNG_VER_STRING,
+        nullptr,
+        nullptr,
+        nullptr
+    );
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (!png || !info) {
+        png_destroy_write_struct(&png, &info);
+        std::fclose(_file);
+        throw Err(9033, "Failed to create PNG struct");
+    }
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        std::fclose(_file);
+        std::filesystem::remove(_filename);
+        throw Err(9034, std::format("Failed to write PNG header of '{}'", f));
+    }
+
+    png_set_compression_level(png, compressionLevel);
+    png_set_filter(png, 0, PNG_FILTER_NONE);
+    png_init_io(png, _file);
+    png_set_IHDR(
+        png,
+        info,
+        _size.x,
+        _size.y,
+        _bytesPerChannel * 8,
+        colorType,
+        PNG_INTERLACE_NONE,
+        PNG_COMPRESSION_TYPE_BASE,
+        PNG_FILTER_TYPE_BASE
+    );
+    png_write_info(png, info);
+
+    _png = png;
+    _info = info;
+}
+
+PngStream::~PngStream() {
+    if (!_png) {
+        // The image was finished when the last band was written
+        return;
+    }
+
+    png_structp png = static_cast<png_structp>(_png);
+    png_infop info = static_cast<png_infop>(_info);
+    png_destroy_write_struct(&png, &info);
+    std::fclose(_file);
+    std::filesystem::remove(_filename);
+    Log::Error(std::format(
+        "Removed incomplete image '{}' with {} of {} rows", _filename, _nRowsWritten,
+        _size.y
+    ));
+}
+
+std::shared_ptr<const int> PngStream::reserveBand() {
+    int index = 0;
+    {
+        const std::unique_lock lock(_mutex);
+        index = _nextReserved++;
+    }
+    return std::shared_ptr<const int>(
+        new int(index),
+        [self = shared_from_this()](const int* p) {
+            self->skip(*p);
+            delete p;
+        }
+    );
+}
+
+void PngStream::submit(int index, std::shared_ptr<const Image> band, int nRows) {
+    if (!band || band->size().x != _size.x || band->size().y < nRows ||
+        band->channels() != _nChannels || band->bytesPerChannel() != _bytesPerChannel)
+    {
+        throw Err(9035, std::format("Band {} does not fit image '{}'", index, _filename));
+    }
+
+    std::unique_lock lock(_mutex);
+    _pending.insert_or_assign(index, Band{ std::move(band), nRows });
+    writePending(lock);
+}
+
+void PngStream::skip(int index) {
+    std::unique_lock lock(_mutex);
+    if (index < _nextWritten || _pending.contains(index)) {
+        // The band has already been submitted
+        return;
+    }
+    _pending.emplace(index, Band());
+    writePending(lock);
+}
+
+void PngStream::writePending(std::unique_lock<std::mutex>& lock) {
+    // Only one thread writes at a time. The others only add their bands, which the
+    // writing thread picks up before it returns
+    while (!_isWriting && !_pending.empty() && _pending.begin()->first == _nextWritten) {
+        _isWriting = true;
+        auto node = _pending.extract(_pending.begin());
+
+        lock.unlock();
+        if (!_hasFailed) {
+            if (node.mapped().image) {
+                write(node.mapped());
+            }
+            else {
+                // Without this band, the rows of all following bands would end up in
+                // the wrong place
+                _hasFailed = true;
+                Log::Error(std::format(
+                    "Band {} of '{}' was dropped", node.key(), _filename
+                ));
+            }
+        }
+        node = {};
+        lock.lock();
+
+        _isWriting = false;
+        _nextWritten++;
+    }
+}
+
+void PngStream::write(const Band& band) {
+    ZoneScoped;
+
+    png_structp png = static_cast<png_structp>(_png);
+    if (setjmp(png_jmpbuf(png))) {
+        _hasFailed = true;
+        Log::Error(std::format("Failed to compress rows of '{}'", _filename));
+        return;
+    }
+
+    if (_nRowsWritten + band.nRows > _size.y) {
+        _hasFailed = true;
+        Log::Error(std::format("Too many rows for image '{}'", _filename));
+        return;
+    }
+
+    // The band is stored bottom-up like all images and the PNG is written top-down
+    const size_t rowSize = _row.size();
+    const unsigned char* data = band.image->data();
+    for (int y = band.nRows - 1; y >= 0; y--) {
+        pixelconversion::convertToPngLayout(
+            data + y * rowSize,
+            _row.data(),
+            _size.x,
+            _nChannels,
+            _bytesPerChannel
+        );
+        png_write_row(png, _row.data());
+    }
+    _nRowsWritten += band.nRows;
+
+    if (_nRowsWritten == _size.y) {
+        finish();
+    }
+}
+
+void PngStream::finish() {
+    png_structp png = static_cast<png_structp>(_png);
+    png_infop info = static_cast<png_infop>(_info);
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+    _png = nullptr;
+    _info = nullptr;
+
+    const bool hasError = std::ferror(_file) != 0;
+    std::fclose(_file);
+    _file = nullptr;
+    if (hasError) {
+        _hasFailed = true;
+        std::filesystem::remove(_filename);
+        Log::Error(std::format("Error writing PNG file '{}'", _filename));
+        return;
+    }
+
+    const double t = (time() - _startTime) * 1000.0;
+    Log::Debug(std::format(
+        "'{}' was saved successfully in {} bands ({:.2f} ms)",
+        _filename, _nextWritten + 1, t
+    ));
+}
+
+} // namespace sgct
@@ -8,88 +8,479 @@
 
 #include <sgct/screencapture.h>
 
+#include <sgct/bufferpool.h>
 #include <sgct/clustermanager.h>
 #include <sgct/engine.h>
 #include <sgct/format.h>
 #include <sgct/image.h>
 #include <sgct/log.h>
 #include <sgct/opengl.h>
+#include <sgct/pixelconversion.h>
 #include <sgct/profiling.h>
 #include <sgct/window.h>
 #include <algorithm>
 #include <array>
-#include <chrono>
 #include <cstring>
 #include <filesystem>
+#include <limits>
+#include <map>
 #include <stdexcept>
+#include <string_view>
 #include <utility>
 
 namespace sgct {
 
+namespace {
+    // Timeout for a single blocking wait for a readback fence
+    constexpr GLuint64 FenceTimeout = 1'000'000'000; // 1s
+
+    std::vector<ScreenCapture*> ScreenCaptures;
+
+    // The container files that are currently open. All ScreenCaptures that write to the
+    // same file share the writer, which is closed when the last of them is destroyed
+    std::map<std::filesystem::path, std::weak_ptr<CaptureContainerWriter>> Containers;
+
+    // The writer that is shared by all ScreenCaptures that use one, so that the files of
+    // all windows go through the same queue to the disk
+    std::weak_ptr<CaptureWriter> Writer;
+
+    ScreenCapture::Settings CaptureSettings;
+
+    bool OfflineExport = false;
+
+    // The durations of the encoding and writing on the capture threads since the
+    // statistics were last updated
+    struct {
+        std::mutex mutex;
+        double encodeTime = 0.0;
+        int nEncoded = 0;
+        double writeTime = 0.0;
+        int nWritten = 0;
+    } JobTimes;
+
+    // The time that the render thread waited for readbacks since the last update
+    double ReadbackWaitTime = 0.0;
+
+    void recordEncodeTime(double t) {
+        const std::unique_lock lock(JobTimes.mutex);
+        JobTimes.encodeTime += t;
+        JobTimes.nEncoded++;
+    }
+
+    void recordWriteTime(double t) {
+        const std::unique_lock lock(JobTimes.mutex);
+        JobTimes.writeTime += t;
+        JobTimes.nWritten++;
+    }
+
+    std::vector<unsigned char> encodeFrame(const Image& image,
+                                           const std::filesystem::path& filename)
+    {
+        const double t0 = time();
+        std::vector<unsigned char> data = image.encode(filename);
+        recordEncodeTime(time() - t0);
+        return data;
+    }
+
+    // Writes the encoded frame through the \p writer, or directly if there is none
+    void writeFrame(const std::filesystem::path& filename,
+                    std::vector<unsigned char> data, CaptureWriter* writer)
+    {
+        const double t0 = time();
+        if (writer) {
+            writer->write(filename, std::move(data));
+        }
+        else {
+            Image::writeFile(filename, data);
+        }
+        recordWriteTime(time() - t0);
+    }
+
+    bool isVideoFormat(ScreenCapture::CaptureFormat format) {
+        return format == ScreenCapture::CaptureFormat::Y4M ||
+            format == ScreenCapture::CaptureFormat::RawRGB;
+    }
+
+    // Returns the format in which frames with the provided type of channels are written
+    // if \p format was requested. Floating-point frames can only be written as EXR, and
+    // only PNG supports more than 8 bits per channel for integer frames
+    ScreenCapture::CaptureFormat supportedFormat(ScreenCapture::CaptureFormat format,
+                                                 int bytesPerColor, bool isFloat)
+    {
+        using CaptureFormat = ScreenCapture::CaptureFormat;
+        if (isFloat) {
+            return CaptureFormat::EXR;
+        }
+        if (format == CaptureFormat::EXR ||
+            (format != CaptureFormat::PNG && bytesPerColor != 1))
+        {
+            return CaptureFormat::PNG;
+        }
+        return format;
+    }
+
+    // Returns the factor by which the previews are smaller than the frames, or 1 if the
+    // requested \p factor is not supported for these frames
+    int supportedPreviewFactor(int factor, int bytesPerColor, bool isFloat,
+                               int bandHeight)
+    {
+        if (factor <= 1) {
+            return 1;
+        }
+        if (factor != 2 && factor != 4 && factor != 8) {
+            Log::Warning(std::format(
+                "Unsupported preview factor {}, must be 2, 4, or 8", factor
+            ));
+            return 1;
+        }
+        if (bytesPerColor != 1 || isFloat || bandHeight > 0) {
+            Log::Warning("Previews are only supported for 8-bit frames without bands");
+            return 1;
+        }
+        return factor;
+    }
+
+    // The preview of a frame is written next to the frame with a suffix
+    std::filesystem::path previewFilename(const std::string& filename) {
+        std::filesystem::path file = filename;
+        file.replace_extension();
+        file += "_preview.png";
+        return file;
+    }
+
+    void savePreview(const Image& frame, int factor, const std::filesystem::path& file,
+                     CaptureWriter* writer)
+    {
+        ZoneScoped;
+
+        const ivec2 size = ivec2{ frame.size().x / factor, frame.size().y / factor };
+        if (size.x == 0 || size.y == 0) {
+            return;
+        }
+        Image preview;
+        preview.setBytesPerChannel(1);
+        preview.setChannels(frame.channels());
+        preview.setSize(size);
+        preview.allocateOrResizeData();
+        preview.setPngCompressionLevel(CaptureSettings.pngCompressionLevel);
+        pixelconversion::downscale(
+            frame.data(),
+            frame.size(),
+            frame.channels(),
+            factor,
+            preview.data()
+        );
+        if (writer) {
+            writer->write(file, preview.encode(file));
+        }
+        else {
+            preview.save(file);
+        }
+    }
+
+    std::string_view extension(ScreenCapture::CaptureFormat format) {
+        switch (format) {
+            case ScreenCapture::CaptureFormat::PNG: return "png";
+            case ScreenCapture::CaptureFormat::QOI: return "qoi";
+            case ScreenCapture::CaptureFormat::Y4M: return "y4m";
+            case ScreenCapture::CaptureFormat::RawRGB: return "rgb";
+            case ScreenCapture::CaptureFormat::EXR: return "exr";
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }
+} // namespace
+
+void ScreenCapture::setSettings(Settings settings) {
+    CaptureSettings = std::move(settings);
+}
+
+const ScreenCapture::Settings& ScreenCapture::settings() {
+    return CaptureSettings;
+}
+
+void ScreenCapture::setOfflineExport(bool enabled) {
+    if (enabled == OfflineExport) {
+        return;
+    }
+    OfflineExport = enabled;
+    for (ScreenCapture* sc : ScreenCaptures) {
+        sc->_pool->setOverflowPolicy(
+            enabled ? CapturePool::OverflowPolicy::Block : sc->_overflowPolicy
+        );
+    }
+    Log::Info(std::format("Offline export {}", enabled ? "enabled" : "disabled"));
+}
+
+bool ScreenCapture::isOfflineExport() {
+    return OfflineExport;
+}
+
+void ScreenCapture::processPendingReadbacks(Engine::Statistics& statistics) {
+    ZoneScoped;
+
+    if (ScreenCaptures.empty()) {
+        return;
+    }
+
+    size_t queueDepth = 0;
+    uint64_t nDroppedFrames = 0;
+    for (ScreenCapture* sc : ScreenCaptures) {
+        sc->collectReadbacks(false);
+        queueDepth += sc->_pool->queueDepth();
+        nDroppedFrames += sc->_pool->nDroppedJobs();
+    }
+
+    statistics.captureQueueDepth.add(static_cast<double>(queueDepth));
+    statistics.captureReadbackWaitTimes.add(ReadbackWaitTime);
+    statistics.droppedCaptureFrames.add(static_cast<double>(nDroppedFrames));
+    ReadbackWaitTime = 0.0;
+
+    const std::unique_lock lock(JobTimes.mutex);
+    const double encodeTime =
+        JobTimes.nEncoded > 0 ?
+        JobTimes.encodeTime / JobTimes.nEncoded :
+        statistics.captureEncodeTimes.newest();
+    const double writeTime =
+        JobTimes.nWritten > 0 ?
+        JobTimes.writeTime / JobTimes.nWritten :
+        statistics.captureWriteTimes.newest();
+    statistics.captureEncodeTimes.add(encodeTime);
+    statistics.captureWriteTimes.add(writeTime);
+    JobTimes.encodeTime = 0.0;
+    JobTimes.nEncoded = 0;
+    JobTimes.writeTime = 0.0;
+    JobTimes.nWritten = 0;
+}
+
+std::unique_ptr<ScreenCapture> ScreenCapture::createStereoCapture(const Window& window) {
+    const auto it = std::find_if(
+        ScreenCaptures.begin(),
+        ScreenCaptures.end(),
+        [&window](const ScreenCapture* sc) {
+            return &sc->_window == &window && sc->_eyeIndex != EyeIndex::Stereo;
+        }
+    );
+    if (it == ScreenCaptures.end()) {
+        return nullptr;
+    }
+    const ScreenCapture& eye = **it;
+    return std::make_unique<ScreenCapture>(
+        window,
+        EyeIndex::Stereo,
+        eye._bytesPerColor,
+        eye._downloadType,
+        eye._addAlpha
+    );
+}
+
 ScreenCapture::ScreenCapture(const Window& window, ScreenCapture::EyeIndex ei,
                              int bytesPerColor, unsigned int colorDataType, bool addAlpha)
-    : _nThreads(Engine::instance().settings().capture.nCaptureThreads)
+    : _overflowPolicy(CaptureSettings.overflowPolicy)
     , _downloadType(colorDataType)
     , _bytesPerColor(bytesPerColor)
+    , _isFloat(colorDataType == GL_HALF_FLOAT || colorDataType == GL_FLOAT)
     , _addAlpha(addAlpha)
+    , _usePersistentMapping(CaptureSettings.usePersistentMapping)
+    , _format(supportedFormat(CaptureSettings.format, bytesPerColor, _isFloat))
+    , _bandHeight(
+        _format == CaptureFormat::PNG && !CaptureSettings.useContainer ?
+        std::max(CaptureSettings.bandHeight, 0) :
+        0
+    )
+    , _previewFactor(
+        supportedPreviewFactor(
+            CaptureSettings.previewFactor,
+            bytesPerColor,
+            _isFloat,
+            _bandHeight
+        )
+    )
+    , _previewInterval(std::max(CaptureSettings.previewInterval, 1))
     , _eyeIndex(ei)
+    , _stereoLayout(CaptureSettings.stereoLayout)
     , _window(window)
 {
-    _captureInfos.resize(_nThreads);
-    for (unsigned int i = 0; i < _nThreads; i++) {
-        _captureInfos[i].frameBufferImage = nullptr;
-        _captureInfos[i].captureThread = nullptr;
-        _captureInfos[i].mutex = &_mutex;
-        _captureInfos[i].isRunning = false;
-    }
-    Log::Debug(std::format("Number of screencapture threads is set to {}", _nThreads));
-}
+    const int nThreads = Engine::instance().settings().capture.nCaptureThreads;
+    // The workers that are not busy with a frame of their own help compressing the
+    // strips of the frames of the others
+    _pool = std::make_unique<CapturePool>(
+        std::max(nThreads, CaptureSettings.nEncoderThreads),
+        CaptureSettings.queueLength,
+        OfflineExport ? CapturePool::OverflowPolicy::Block : _overflowPolicy
+    );
+    if (CaptureSettings.adaptivePngBudget > 0.0 && _format == CaptureFormat::PNG &&
+        _bandHeight == 0)
+    {
+        // With n threads, each frame can take n times as long as the time between two
+        // captured frames
+        _compression = std::make_shared<CompressionController>(
+            CaptureSettings.adaptivePngBudget * std::max(nThreads, 1),
+            CaptureSettings.queueLength,
+            CompressionController::Setting{
+                CaptureSettings.pngCompressionLevel,
+                CaptureSettings.pngFilter
+            }
+        );
+    }
 
-ScreenCapture::~ScreenCapture() {
-    for (ScreenCaptureThreadInfo& info : _captureInfos) {
-        // Kill threads that are still running
-        if (info.captureThread) {
-            info.captureThread->join();
-            info.captureThread = nullptr;
+    if (CaptureSettings.useCaptureWriter && !CaptureSettings.useContainer &&
+        !isVideoFormat(_format) && _bandHeight == 0)
+    {
+        _writer = Writer.lock();
+        if (!_writer) {
+            _writer = std::make_shared<CaptureWriter>(CaptureSettings.writer);
+            Writer = _writer;
         }
+    }
 
-        const std::unique_lock lock(_mutex);
-        info.frameBufferImage = nullptr;
-        info.isRunning = false;
+    // A readback is mapped at the earliest one frame after it was issued and at the
+    // latest when the ring is full. With persistent mapping a buffer is in use until
+    // its frame has been written, so there need to be enough buffers for all frames
+    // that the pool is working on
+    const int depth = std::max(CaptureSettings.readbackDepth, 1);
+    const int nBuffers =
+        _usePersistentMapping ? depth + CaptureSettings.queueLength + nThreads : depth;
+    _readbacks.resize(nBuffers);
+    ScreenCaptures.push_back(this);
+    Log::Debug(std::format("Number of screencapture threads is set to {}", nThreads));
+    if (_format != CaptureSettings.format) {
+        Log::Warning(std::format(
+            "The capture format '{}' does not support {}-bit {} images, saving captures "
+            "as '{}'", extension(CaptureSettings.format), bytesPerColor * 8,
+            _isFloat ? "floating-point" : "integer", extension(_format)
+        ));
     }
+}
+
+ScreenCapture::~ScreenCapture() {
+    ScreenCaptures.erase(
+        std::remove(ScreenCaptures.begin(), ScreenCaptures.end(), this),
+        ScreenCaptures.end()
+    );
 
-    glDeleteBuffers(1, &_pbo);
+    // Readbacks that are still in flight have to be written before shutting down
+    collectReadbacks(true);
+
+    // Destroying the pool finishes all frames that are still queued. The files are
+    // written before the last ScreenCapture releases the writer
+    _pool = nullptr;
+    _writer = nullptr;
+
+    destroyBuffers();
+
+    // The frames of the last capture no longer need to be recycled
+    if (ScreenCaptures.empty()) {
+        BufferPool::instance().clear();
+    }
 }
 
 void ScreenCapture::resize(ivec2 resolution) {
-    glDeleteBuffers(1, &_pbo);
+    // The readbacks in flight were done with the old resolution and have to be written
+    // before the buffers and images are recreated
+    collectReadbacks(true);
 
-    _resolution = std::move(resolution);
+    // All images and mapped buffers that are currently used by capture jobs have the
+    // old size
+    _pool->waitForIdle();
+    {
+        // The memory of the images goes back to the buffer pool, from where images of
+        // the same size class, for example after resizing back, get it without a new
+        // allocation
+        const std::unique_lock lock(_mutex);
+        _freeImages.clear();
+    }
+    destroyBuffers();
+
+    const BufferPool::Statistics pool = BufferPool::instance().statistics();
+    Log::Debug(std::format(
+        "Image buffer pool: {} hits, {} misses, {} bytes in use, {} bytes cached",
+        pool.nHits, pool.nMisses, pool.nBytesInUse, pool.nBytesCached
+    ));
+
+    // A video stream cannot change its size, so the frames with the new size go into a
+    // new stream that is opened with the next capture
+    _videoStream = nullptr;
+
+    _eyeResolution = std::move(resolution);
+    _resolution = _eyeResolution;
+    if (_eyeIndex == EyeIndex::Stereo && _stereoLayout == StereoLayout::SideBySide) {
+        _resolution.x *= 2;
+    }
+    else if (_eyeIndex == EyeIndex::Stereo) {
+        _resolution.y *= 2;
+    }
+    _readbackRows =
+        _bandHeight > 0 ? std::min(_bandHeight, _resolution.y) : _resolution.y;
 
     const int nChannels = _addAlpha ? 4 : 3;
-    _dataSize = _resolution.x * _resolution.y * nChannels * _bytesPerColor;
-
-    const std::unique_lock lock(_mutex);
-    for (ScreenCaptureThreadInfo& info : _captureInfos) {
-        if (info.frameBufferImage) {
-            // Kill threads that are still running
-            if (info.captureThread) {
-                info.captureThread->join();
-                info.captureThread = nullptr;
+    _dataSize = static_cast<size_t>(_resolution.x) * static_cast<size_t>(_readbackRows) *
+        static_cast<size_t>(nChannels) * static_cast<size_t>(_bytesPerColor);
+
+    const GLbitfield flags =
+        _usePersistentMapping ?
+        GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT :
+        GL_MAP_READ_BIT;
+    const GLsizeiptr size = static_cast<GLsizeiptr>(_dataSize);
+    for (ReadbackSlot& slot : _readbacks) {
+        glCreateBuffers(1, &slot.pbo);
+        glNamedBufferStorage(slot.pbo, size, nullptr, flags);
+        if (_usePersistentMapping) {
+            slot.mapping = reinterpret_cast<unsigned char*>(
+                glMapNamedBufferRange(slot.pbo, 0, size, flags)
+            );
+            if (!slot.mapping) {
+                Log::Error(std::format("Can't persistently map PBO {}", slot.pbo));
             }
-            info.frameBufferImage = nullptr;
         }
-        info.isRunning = false;
+        Log::Debug(std::format(
+            "Generating {}x{}x{} PBO: {}",
+            _resolution.x, _readbackRows, nChannels, slot.pbo
+        ));
     }
+    _nextReadback = 0;
+}
 
-    Log::Debug(std::format(
-        "Generating {}x{}x{} PBO: {}", _resolution.x, _resolution.y, nChannels, _pbo
-    ));
-    glCreateBuffers(1, &_pbo);
-    glNamedBufferStorage(_pbo, _dataSize, nullptr, GL_MAP_READ_BIT);
+void ScreenCapture::destroyBuffers() {
+    for (ReadbackSlot& slot : _readbacks) {
+        if (slot.mapping) {
+            glUnmapNamedBuffer(slot.pbo);
+            slot.mapping = nullptr;
+        }
+        glDeleteBuffers(1, &slot.pbo);
+        slot.pbo = 0;
+    }
 }
 
 void ScreenCapture::saveScreenCapture(unsigned int textureId, CaptureSource capSrc) {
+    if (_eyeIndex == EyeIndex::Stereo) {
+        Log::Error("A stereo capture needs the images of both eyes");
+        return;
+    }
+    capture({ Source{ textureId, capSrc }, Source() });
+}
+
+void ScreenCapture::saveStereoScreenCapture(unsigned int leftTextureId,
+                                            unsigned int rightTextureId,
+                                            CaptureSource capSrc)
+{
+    if (_eyeIndex != EyeIndex::Stereo) {
+        Log::Error("Only a stereo capture can capture both eyes");
+        return;
+    }
+    const bool isTexture = capSrc == CaptureSource::Texture;
+    capture({
+        Source{
+            leftTextureId,
+            isTexture ? CaptureSource::Texture : CaptureSource::LeftBackBuffer
+        },
+        Source{
+            rightTextureId,
+            isTexture ? CaptureSource::Texture : CaptureSource::RightBackBuffer
+        }
+    });
+}
+
+void ScreenCapture::capture(const std::array<Source, 2>& sources) {
     ZoneScoped;
 
     uint64_t number = Engine::instance().screenShotNumber();
@@ -107,85 +498,388 @@ void ScreenCapture::saveScreenCapture(unsigned int textureId, CaptureSource capS
 
     std::string file = createFilename(number);
 
+    if (CaptureSettings.useContainer && !isVideoFormat(_format) && !_container) {
+        const std::filesystem::path path = createContainerFilename();
+        _container = Containers[path].lock();
+        if (!_container) {
+            _container = std::make_shared<CaptureContainerWriter>(
+                path,
+                CaptureSettings.containerPreallocation
+            );
+            Containers[path] = _container;
+        }
+    }
+
     const ivec2 res =
-        capSrc == CaptureSource::Texture ?
+        sources[0].capSrc == CaptureSource::Texture ?
         _window.framebufferResolution() :
         _window.windowResolution();
-    if (_resolution.x != res.x || _resolution.y != res.y) {
+    if (_eyeResolution.x != res.x || _eyeResolution.y != res.y) {
         resize(res);
     }
 
-    const int threadIndex = availableCaptureThread();
-    if (threadIndex == -1) {
-        Log::Error("Error finding available capture thread");
+    if (isVideoFormat(_format) && !_videoStream) {
+        // The stream is named after its first frame so that a stream that is restarted
+        // after a resize does not overwrite the previous one
+        std::string destination = file;
+        if (!CaptureSettings.videoCommand.empty()) {
+            const std::string name =
+                std::filesystem::path(file).replace_extension().string();
+            std::string command = CaptureSettings.videoCommand;
+            constexpr std::string_view Placeholder = "{name}";
+            for (size_t p = command.find(Placeholder);
+                 p != std::string::npos;
+                 p = command.find(Placeholder, p + name.size()))
+            {
+                command.replace(p, Placeholder.size(), name);
+            }
+            destination = '|' + command;
+        }
+        _videoStream = std::make_shared<VideoStream>(
+            std::move(destination),
+            _format == CaptureFormat::Y4M ?
+                VideoStream::Format::Y4M :
+                VideoStream::Format::RawRGB,
+            _resolution,
+            CaptureSettings.videoFrameRate
+        );
+    }
+
+    if (_bandHeight > 0) {
+        // The bands are read from the top as that is where the PNG file starts. Every
+        // band is handed to the capture threads on its own, so only the bands that are
+        // in flight or queued are in memory
+        const int h = _resolution.y;
+        auto stream = std::make_shared<PngStream>(
+            file,
+            _resolution,
+            _addAlpha ? 4 : 3,
+            _bytesPerColor,
+            CaptureSettings.pngCompressionLevel
+        );
+        for (int top = h; top > 0; top -= _readbackRows) {
+            const int nRows = std::min(_readbackRows, top);
+            ReadbackSlot& slot = nextReadbackSlot();
+            slot.stream = stream;
+            slot.band = stream->reserveBand();
+            slot.nRows = nRows;
+            slot.filename = file;
+            slot.frameNumber = number;
+            readPixels(slot, sources, top - nRows, nRows);
+        }
         return;
     }
 
-    Image* imPtr = prepareImage(threadIndex, std::move(file));
+    ReadbackSlot& slot = nextReadbackSlot();
+    slot.filename = std::move(file);
+    slot.frameNumber = number;
+    readPixels(slot, sources, 0, _resolution.y);
+}
+
+ScreenCapture::ReadbackSlot& ScreenCapture::nextReadbackSlot() {
+    // Hand off everything that has already arrived. If the ring is still full after
+    // that, the GPU is more than a full ring behind and we have to wait for the oldest
+    collectReadbacks(false);
+    if (_nReadbacksInFlight == _readbacks.size()) {
+        Log::Debug(std::format(
+            "Waiting for screenshot readback issued {:.2f} ms ago",
+            oldestPendingReadbackAge() * 1000.0
+        ));
+        const size_t oldest =
+            (_nextReadback + _readbacks.size() - _nReadbacksInFlight) % _readbacks.size();
+        finishReadback(_readbacks[oldest]);
+        _nReadbacksInFlight--;
+    }
+
+    ReadbackSlot& slot = _readbacks[_nextReadback];
+    if (_usePersistentMapping) {
+        // The buffer might still be read by the encoder of an older frame
+        std::unique_lock lock(_mutex);
+        _bufferReleased.wait(lock, [&slot]() { return !slot.isBorrowed; });
+    }
+    return slot;
+}
+
+void ScreenCapture::readPixels(ReadbackSlot& slot, const std::array<Source, 2>& sources,
+                               int y, int nRows)
+{
+    const GLenum format = _addAlpha ? GL_BGRA : GL_BGR;
+    const int pixelSize = (_addAlpha ? 4 : 3) * _bytesPerColor;
+    const bool isStereo = _eyeIndex == EyeIndex::Stereo;
+
     glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbo);
+    // With side-by-side stereo, the rows of an eye are only half as long as the rows of
+    // the frame
+    glPixelStorei(GL_PACK_ROW_LENGTH, isStereo ? _resolution.x : 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
 
-    if (capSrc == CaptureSource::Texture) {
-        glBindTexture(GL_TEXTURE_2D, textureId);
-        glGetTexImage(
-            GL_TEXTURE_2D,
-            0,
-            _addAlpha ? GL_BGRA : GL_BGR,
-            _downloadType,
-            nullptr
+    for (int eye = 0; eye < (isStereo ? 2 : 1); eye++) {
+        // The position of the eye in the frame. The frame is stored bottom-up, so the
+        // upper left eye of the top-bottom layout starts after the right eye
+        const ivec2 offset = ivec2{
+            isStereo && eye == 1 && _stereoLayout == StereoLayout::SideBySide ?
+                _eyeResolution.x :
+                0,
+            isStereo && eye == 0 && _stereoLayout == StereoLayout::TopBottom ?
+                _eyeResolution.y :
+                0
+        };
+
+        // The rows of the eye that are part of the requested rows of the frame
+        const int begin = std::max(y, offset.y);
+        const int end = std::min(y + nRows, offset.y + _eyeResolution.y);
+        if (begin >= end) {
+            continue;
+        }
+        const GLsizei w = static_cast<GLsizei>(_eyeResolution.x);
+        const GLsizei h = static_cast<GLsizei>(end - begin);
+        const GLint eyeY = static_cast<GLint>(begin - offset.y);
+        void* destination = reinterpret_cast<void*>(
+            (static_cast<size_t>(begin - y) * _resolution.x + offset.x) * pixelSize
         );
+
+        const Source& source = sources[eye];
+        if (source.capSrc == CaptureSource::Texture && h == _eyeResolution.y) {
+            glBindTexture(GL_TEXTURE_2D, source.textureId);
+            glGetTexImage(GL_TEXTURE_2D, 0, format, _downloadType, destination);
+        }
+        else if (source.capSrc == CaptureSource::Texture) {
+            glGetTextureSubImage(
+                source.textureId,
+                0,
+                0,
+                eyeY,
+                0,
+                w,
+                h,
+                1,
+                format,
+                _downloadType,
+                // The size of the buffer is limited by the range of the parameter
+                static_cast<GLsizei>(
+                    std::min<size_t>(_dataSize, std::numeric_limits<GLsizei>::max())
+                ),
+                destination
+            );
+        }
+        else {
+            // Set the target framebuffer to read
+            switch (source.capSrc) {
+                case CaptureSource::BackBuffer:
+                    glReadBuffer(GL_BACK);
+                    break;
+                case CaptureSource::LeftBackBuffer:
+                    glReadBuffer(GL_BACK_LEFT);
+                    break;
+                case CaptureSource::RightBackBuffer:
+                    glReadBuffer(GL_BACK_RIGHT);
+                    break;
+                default:
+                    throw std::logic_error("Unhandled case label");
+            }
+            glReadPixels(0, eyeY, w, h, format, _downloadType, destination);
+        }
     }
-    else {
-        // Set the target framebuffer to read
-        switch (capSrc) {
-            case CaptureSource::BackBuffer:
-                glReadBuffer(GL_BACK);
-                break;
-            case CaptureSource::LeftBackBuffer:
-                glReadBuffer(GL_BACK_LEFT);
-                break;
-            case CaptureSource::RightBackBuffer:
-                glReadBuffer(GL_BACK_RIGHT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.timestamp = time();
+    _nextReadback = (_nextReadback + 1) % _readbacks.size();
+    _nReadbacksInFlight++;
+}
+
+int ScreenCapture::framesInFlight() const {
+    return static_cast<int>(_nReadbacksInFlight);
+}
+
+double ScreenCapture::oldestPendingReadbackAge() const {
+    if (_nReadbacksInFlight == 0) {
+        return 0.0;
+    }
+    const size_t oldest =
+        (_nextReadback + _readbacks.size() - _nReadbacksInFlight) % _readbacks.size();
+    return time() - _readbacks[oldest].timestamp;
+}
+
+void ScreenCapture::collectReadbacks(bool waitForAll) {
+    while (_nReadbacksInFlight > 0) {
+        const size_t oldest =
+            (_nextReadback + _readbacks.size() - _nReadbacksInFlight) % _readbacks.size();
+        ReadbackSlot& slot = _readbacks[oldest];
+
+        if (!waitForAll) {
+            const GLenum res = glClientWaitSync(
+                static_cast<GLsync>(slot.fence),
+                GL_SYNC_FLUSH_COMMANDS_BIT,
+                0
+            );
+            if (res == GL_TIMEOUT_EXPIRED) {
+                // The readbacks are handed off in order, so if this one is not done, we
+                // don't need to check the newer ones
                 break;
-            default:
-                throw std::logic_error("Unhandled case label");
+            }
         }
-        const ivec2& s = imPtr->size();
-        const GLsizei w = static_cast<GLsizei>(s.x);
-        const GLsizei h = static_cast<GLsizei>(s.y);
-        glReadPixels(0, 0, w, h, _addAlpha ? GL_BGRA : GL_BGR, _downloadType, nullptr);
+
+        finishReadback(slot);
+        _nReadbacksInFlight--;
     }
 
-    unsigned char* memoryPtr = reinterpret_cast<unsigned char*>(
-        glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY)
-    );
-    if (memoryPtr) {
-        std::memcpy(imPtr->data(), memoryPtr, _dataSize);
-
-        // Save the image
-        _captureInfos[threadIndex].isRunning = true;
-        _captureInfos[threadIndex].captureThread = std::make_unique<std::thread>(
-            [](void* arg) {
-                ScreenCaptureThreadInfo* ptr =
-                    reinterpret_cast<ScreenCaptureThreadInfo*>(arg);
-
-                try {
-                    ptr->frameBufferImage->save(ptr->filename);
-                }
-                catch (const std::runtime_error& e) {
-                    Log::Error(e.what());
-                }
-                ptr->isRunning = false;
-            },
-            &_captureInfos[threadIndex]
-        );
-        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    if (_nReadbacksInFlight > 0) {
+        Log::Debug(std::format(
+            "{} screenshot readbacks in flight, oldest issued {:.2f} ms ago",
+            _nReadbacksInFlight, oldestPendingReadbackAge() * 1000.0
+        ));
+    }
+}
+
+void ScreenCapture::finishReadback(ReadbackSlot& slot) {
+    ZoneScoped;
+
+    // If the band is not submitted because the readback failed, releasing the ticket
+    // marks the image as incomplete
+    std::shared_ptr<PngStream> stream = std::move(slot.stream);
+    std::shared_ptr<const int> band = std::move(slot.band);
+
+    GLsync fence = static_cast<GLsync>(slot.fence);
+    const double t0 = time();
+    GLenum res = GL_TIMEOUT_EXPIRED;
+    while (res == GL_TIMEOUT_EXPIRED) {
+        res = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceTimeout);
+    }
+    ReadbackWaitTime += time() - t0;
+    glDeleteSync(fence);
+    slot.fence = nullptr;
+
+    if (res == GL_WAIT_FAILED) {
+        Log::Error(std::format("Failed waiting for readback of '{}'", slot.filename));
+        return;
+    }
+
+    std::shared_ptr<Image> image =
+        _usePersistentMapping ? borrowImage(slot) : copyImage(slot);
+    if (!image) {
+        return;
+    }
+
+    // The preview is computed on the capture thread before the frame is encoded, which
+    // keeps it in the same queue slot as its frame
+    std::filesystem::path preview;
+    if (_previewFactor > 1 && slot.frameNumber % _previewInterval == 0) {
+        preview = previewFilename(slot.filename);
+    }
+
+    CapturePool::Job job;
+    if (stream) {
+        job = [image, stream, band, nRows = slot.nRows]() {
+            stream->submit(*band, image, nRows);
+        };
+    }
+    else if (_videoStream) {
+        // The position in the stream is reserved here as the readbacks are finished in
+        // order, while the conversion might finish out of order on the capture threads
+        std::shared_ptr<const uint64_t> position = _videoStream->reserveFrame();
+        job = [image, stream = _videoStream, position]() {
+            const double t0 = time();
+            std::vector<unsigned char> frame = stream->encode(*image);
+            const double t1 = time();
+            recordEncodeTime(t1 - t0);
+            stream->submit(*position, std::move(frame));
+            recordWriteTime(time() - t1);
+        };
+    }
+    else if (_container) {
+        capturecontainer::Entry entry;
+        entry.frameNumber = slot.frameNumber;
+        entry.windowId = _window.id();
+        entry.width = _resolution.x;
+        entry.height = _resolution.y;
+        entry.eye = static_cast<uint8_t>(_eyeIndex);
+        entry.nChannels = static_cast<uint8_t>(image->channels());
+        entry.bytesPerChannel = static_cast<uint8_t>(_bytesPerColor);
+        if (_format == CaptureFormat::QOI) {
+            entry.codec = capturecontainer::Codec::QOI;
+        }
+        else if (_isFloat) {
+            entry.codec = capturecontainer::Codec::RawFloat;
+        }
+        else {
+            entry.codec = capturecontainer::Codec::Raw;
+        }
+
+        job = [image, container = _container, entry, size = _dataSize]() {
+            if (entry.codec == capturecontainer::Codec::QOI) {
+                const double t0 = time();
+                const std::vector<unsigned char> buffer = image->encodeQoi();
+                const double t1 = time();
+                recordEncodeTime(t1 - t0);
+                container->append(entry, buffer.data(), buffer.size());
+                recordWriteTime(time() - t1);
+            }
+            else {
+                const double t0 = time();
+                container->append(entry, image->data(), size);
+                recordWriteTime(time() - t0);
+            }
+        };
+    }
+    else if (_compression && !OfflineExport) {
+        job = [image, filename = std::move(slot.filename), c = _compression,
+               writer = _writer]()
+        {
+            const CompressionController::Setting setting = c->current();
+            image->setPngCompressionLevel(setting.level);
+            image->setPngFilter(setting.filter);
+            const double t0 = time();
+            std::vector<unsigned char> buffer = encodeFrame(*image, filename);
+            if (writer) {
+                // Only the encoding counts, the writer waiting for the disk would not
+                // get faster with a lower level
+                c->reportDuration(setting, time() - t0);
+                writeFrame(filename, std::move(buffer), writer.get());
+            }
+            else {
+                writeFrame(filename, std::move(buffer), nullptr);
+                c->reportDuration(setting, time() - t0);
+            }
+        };
     }
     else {
-        Log::Error("Can't map data (0) from GPU in frame capture");
+        // The controller changes the setting of the images that it is used with
+        if (_compression) {
+            image->setPngCompressionLevel(CaptureSettings.pngCompressionLevel);
+            image->setPngFilter(CaptureSettings.pngFilter);
+        }
+        job = [image, filename = std::move(slot.filename), writer = _writer]() {
+            writeFrame(filename, encodeFrame(*image, filename), writer.get());
+        };
+    }
+    if (!preview.empty()) {
+        job = [job = std::move(job), image, factor = _previewFactor,
+               preview = std::move(preview), writer = _writer]()
+        {
+            try {
+                savePreview(*image, factor, preview, writer.get());
+            }
+            catch (const std::runtime_error& e) {
+                // A failed preview must not cost the frame
+                Log::Error(e.what());
+            }
+            job();
+        };
+    }
+    const bool wasQueued = _pool->enqueue(std::move(job));
+    if (_compression) {
+        _compression->reportQueueDepth(_pool->queueDepth());
     }
 
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    const uint64_t nDropped = _pool->nDroppedJobs();
+    if (!wasQueued || nDropped != _nReportedDroppedFrames) {
+        Log::Warning(std::format(
+            "Capture queue is full. {} frames dropped in total", nDropped
+        ));
+        _nReportedDroppedFrames = nDropped;
+    }
 }
 
 std::string ScreenCapture::createFilename(uint64_t frameNumber) {
@@ -194,6 +888,7 @@ std::string ScreenCapture::createFilename(uint64_t frameNumber) {
             case EyeIndex::Mono:        return "";
             case EyeIndex::StereoLeft:  return "L";
             case EyeIndex::StereoRight: return "R";
+            case EyeIndex::Stereo:      return "LR";
             default:                    throw std::logic_error("Unhandled case label");
         }
     }(_eyeIndex);
@@ -225,47 +920,123 @@ std::string ScreenCapture::createFilename(uint64_t frameNumber) {
         file += eyeSuffix + '_';
     }
     std::string bufferString = std::string(Buffer.begin(), Buffer.end());
-    return std::format("{}{}.png", file, bufferString);
+    return std::format("{}{}.{}", file, bufferString, extension(_format));
 }
 
-int ScreenCapture::availableCaptureThread() {
-    while (true) {
-        for (unsigned int i = 0; i < _captureInfos.size(); i++) {
-            // Check if thread is dead
-            if (_captureInfos[i].captureThread == nullptr) {
-                return i;
-            }
+std::filesystem::path ScreenCapture::createContainerFilename() const {
+    std::filesystem::path file;
+    if (!Engine::instance().settings().capture.capturePath.empty()) {
+        file = Engine::instance().settings().capture.capturePath / "";
+    }
+    if (!Engine::instance().settings().capture.prefix.empty()) {
+        file += Engine::instance().settings().capture.prefix;
+        file += '_';
+    }
+    if (Engine::instance().settings().capture.addNodeName &&
+        ClusterManager::instance().numberOfNodes() > 1)
+    {
+        file += std::format("node{}_", ClusterManager::instance().thisNodeId());
+    }
+    file += "capture.sgctcap";
+    return file;
+}
 
-            if (!_captureInfos[i].isRunning) {
-                _captureInfos[i].captureThread->join();
-                _captureInfos[i].captureThread = nullptr;
+std::shared_ptr<Image> ScreenCapture::copyImage(const ReadbackSlot& slot) {
+    std::shared_ptr<Image> image = acquireImage();
+    if (!image) {
+        return nullptr;
+    }
 
-                return i;
-            }
-        }
+    unsigned char* memoryPtr = reinterpret_cast<unsigned char*>(
+        glMapNamedBufferRange(
+            slot.pbo,
+            0,
+            static_cast<GLsizeiptr>(_dataSize),
+            GL_MAP_READ_BIT
+        )
+    );
+    if (!memoryPtr) {
+        Log::Error("Can't map data (0) from GPU in frame capture");
+        return nullptr;
+    }
+    std::memcpy(image->data(), memoryPtr, _dataSize);
+    glUnmapNamedBuffer(slot.pbo);
+    return image;
+}
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+std::shared_ptr<Image> ScreenCapture::borrowImage(ReadbackSlot& slot) {
+    if (!slot.mapping) {
+        return nullptr;
     }
+
+    {
+        const std::unique_lock lock(_mutex);
+        slot.isBorrowed = true;
+    }
+
+    auto image = std::make_unique<Image>();
+    image->setBytesPerChannel(_bytesPerColor);
+    image->setFloatingPoint(_isFloat);
+    image->setChannels(_addAlpha ? 4 : 3);
+    image->setSize(ivec2{ _resolution.x, _readbackRows });
+    image->setBorrowedData(slot.mapping);
+    image->setEncoderThreads(CaptureSettings.nEncoderThreads);
+    image->setEncoderPool(_pool.get());
+    image->setPngCompressionLevel(CaptureSettings.pngCompressionLevel);
+    image->setPngFilter(CaptureSettings.pngFilter);
+
+    // The buffer can be reused for a new readback as soon as the encoder is done with it
+    // or when the job was dropped from the queue
+    return std::shared_ptr<Image>(
+        image.release(),
+        [this, s = &slot](Image* im) {
+            delete im;
+            {
+                const std::unique_lock lock(_mutex);
+                s->isBorrowed = false;
+            }
+            _bufferReleased.notify_all();
+        }
+    );
 }
 
-Image* ScreenCapture::prepareImage(int index, std::string file) {
-    Log::Debug(std::format("Starting thread for screenshot/capture [{}]", index));
+std::shared_ptr<Image> ScreenCapture::acquireImage() {
+    std::unique_ptr<Image> image;
+    {
+        const std::unique_lock lock(_mutex);
+        if (!_freeImages.empty()) {
+            image = std::move(_freeImages.back());
+            _freeImages.pop_back();
+        }
+    }
 
-    if (_captureInfos[index].frameBufferImage == nullptr) {
+    if (!image) {
         const int nChannels = _addAlpha ? 4 : 3;
-        _captureInfos[index].frameBufferImage = std::make_unique<Image>();
-        _captureInfos[index].frameBufferImage->setBytesPerChannel(_bytesPerColor);
-        _captureInfos[index].frameBufferImage->setChannels(nChannels);
-        _captureInfos[index].frameBufferImage->setSize(_resolution);
-        if (_bytesPerColor * nChannels * _resolution.x * _resolution.y == 0) {
-            _captureInfos[index].frameBufferImage = nullptr;
+        if (_bytesPerColor * nChannels * _resolution.x * _readbackRows == 0) {
             return nullptr;
         }
-        _captureInfos[index].frameBufferImage->allocateOrResizeData();
+        Log::Debug("Allocating new image for screenshot/capture");
+        image = std::make_unique<Image>();
+        image->setBytesPerChannel(_bytesPerColor);
+        image->setFloatingPoint(_isFloat);
+        image->setChannels(nChannels);
+        image->setSize(ivec2{ _resolution.x, _readbackRows });
+        image->allocateOrResizeData();
+        image->setEncoderThreads(CaptureSettings.nEncoderThreads);
+        image->setEncoderPool(_pool.get());
+        image->setPngCompressionLevel(CaptureSettings.pngCompressionLevel);
+        image->setPngFilter(CaptureSettings.pngFilter);
     }
-    _captureInfos[index].filename = std::move(file);
 
-    return _captureInfos[index].frameBufferImage.get();
+    // The image is given back to the list of free images when the capture job has
+    // finished with it or when the job was dropped from the queue
+    return std::shared_ptr<Image>(
+        image.release(),
+        [this](Image* im) {
+            const std::unique_lock lock(_mutex);
+            _freeImages.emplace_back(im);
+        }
+    );
 }
 
 } // namespace sgct
@@ -0,0 +1,426 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/sharedframe.h>
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/image.h>
+#include <sgct/log.h>
+#include <sgct/opengl.h>
+#include <sgct/profiling.h>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+#define Err(code, msg) Error(Error::Component::Image, code, msg)
+
+namespace sgct {
+
+namespace {
+    constexpr uint64_t BufferAlignment = 4096;
+
+    // The number of times a reader tries again after reading a torn frame
+    constexpr int MaxReadAttempts = 4;
+
+    std::string objectName(const std::string& name) {
+        return name.starts_with('/') ? name : '/' + name;
+    }
+
+    double steadyTime() {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    sharedframe::Header& header(unsigned char* mapping) {
+        return *reinterpret_cast<sharedframe::Header*>(mapping);
+    }
+
+    const sharedframe::Header& header(const unsigned char* mapping) {
+        return *reinterpret_cast<const sharedframe::Header*>(mapping);
+    }
+
+    bool hasMagic(const sharedframe::Header& h) {
+        const sharedframe::Header reference;
+        return std::memcmp(h.magic, reference.magic, sizeof(reference.magic)) == 0;
+    }
+
+#ifndef WIN32
+    // Removes an object with the \p name that a sender which did not shut down properly
+    // left behind. Readers that have it open are told to open the new object instead
+    void removeStaleObject(const std::string& name) {
+        const int file = shm_open(name.c_str(), O_RDWR, 0);
+        if (file < 0) {
+            return;
+        }
+        struct stat info = {};
+        if (fstat(file, &info) == 0 &&
+            static_cast<uint64_t>(info.st_size) >= sizeof(sharedframe::Header))
+        {
+            constexpr size_t Size = sizeof(sharedframe::Header);
+            void* m = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+            if (m != MAP_FAILED) {
+                sharedframe::Header& h = *static_cast<sharedframe::Header*>(m);
+                if (hasMagic(h)) {
+                    h.isStale.store(1, std::memory_order_release);
+                }
+                munmap(m, Size);
+            }
+        }
+        ::close(file);
+        shm_unlink(name.c_str());
+    }
+#endif // WIN32
+} // namespace
+
+SharedFrameSender::SharedFrameSender(std::string name)
+    : _name(objectName(name))
+{
+#ifdef WIN32
+    throw Err(9037, "Shared memory frames are not supported on Windows");
+#endif // WIN32
+}
+
+SharedFrameSender::~SharedFrameSender() {
+    destroy();
+}
+
+void SharedFrameSender::send(const unsigned char* data, ivec2 size, int nChannels,
+                             int bytesPerChannel, bool isFloat, uint64_t frameNumber)
+{
+    ZoneScoped;
+
+    const uint64_t frameSize =
+        static_cast<uint64_t>(size.x) * size.y * nChannels * bytesPerChannel;
+    if (!_mapping || frameSize > header(_mapping).bufferSize) {
+        create(frameSize);
+    }
+
+    sharedframe::Header& h = header(_mapping);
+    const uint32_t latest = h.latest.load(std::memory_order_relaxed);
+    const uint32_t index =
+        latest == sharedframe::NoFrame ? 0 : (latest + 1) % sharedframe::NumberOfBuffers;
+    sharedframe::Slot& slot = h.slots[index];
+
+    // The odd sequence number has to be visible before any of the data is changed
+    const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.frameNumber = frameNumber;
+    slot.timestamp = steadyTime();
+    slot.width = size.x;
+    slot.height = size.y;
+    slot.nChannels = static_cast<uint8_t>(nChannels);
+    slot.bytesPerChannel = static_cast<uint8_t>(bytesPerChannel);
+    slot.isFloat = isFloat ? 1 : 0;
+    std::memcpy(_mapping + slot.offset, data, frameSize);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    h.latest.store(index, std::memory_order_release);
+}
+
+const std::string& SharedFrameSender::name() const {
+    return _name;
+}
+
+void SharedFrameSender::create([[maybe_unused]] uint64_t bufferSize) {
+#ifndef WIN32
+    // Readers that still have the old object open see that it is stale and open the new
+    // object with the same name
+    destroy();
+
+    bufferSize = (bufferSize + BufferAlignment - 1) / BufferAlignment * BufferAlignment;
+    const uint64_t headerSize =
+        (sizeof(sharedframe::Header) + BufferAlignment - 1) / BufferAlignment *
+        BufferAlignment;
+    _size = headerSize + sharedframe::NumberOfBuffers * bufferSize;
+
+    // A new object is created every time, so that the memory that readers have mapped
+    // is never resized underneath them
+    removeStaleObject(_name);
+    _file = shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (_file < 0) {
+        throw Err(
+            9038,
+            std::format(
+                "Cannot create shared memory '{}': {}", _name, std::strerror(errno)
+            )
+        );
+    }
+    if (ftruncate(_file, static_cast<off_t>(_size)) != 0) {
+        const int error = errno;
+        destroy();
+        throw Err(
+            9039,
+            std::format(
+                "Cannot resize shared memory '{}' to {} bytes: {}",
+                _name, _size, std::strerror(error)
+            )
+        );
+    }
+    void* mapping = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+    if (mapping == MAP_FAILED) {
+        const int error = errno;
+        destroy();
+        throw Err(
+            9040,
+            std::format("Cannot map shared memory '{}': {}", _name, std::strerror(error))
+        );
+    }
+    _mapping = static_cast<unsigned char*>(mapping);
+
+    sharedframe::Header* h = new (_mapping) sharedframe::Header;
+    h->size = _size;
+    h->bufferSize = bufferSize;
+    for (int i = 0; i < sharedframe::NumberOfBuffers; i++) {
+        h->slots[i].offset = headerSize + i * bufferSize;
+    }
+
+    Log::Info(std::format(
+        "Sending frames through shared memory '{}' with {} buffers of {} bytes",
+        _name, sharedframe::NumberOfBuffers, bufferSize
+    ));
+#endif // WIN32
+}
+
+void SharedFrameSender::destroy() {
+#ifndef WIN32
+    if (_mapping) {
+        header(_mapping).isStale.store(1, std::memory_order_release);
+        munmap(_mapping, _size);
+        _mapping = nullptr;
+    }
+    if (_file >= 0) {
+        ::close(_file);
+        shm_unlink(_name.c_str());
+        _file = -1;
+    }
+#endif // WIN32
+}
+
+SharedFramePublisher::SharedFramePublisher(std::string name)
+    : _sender(std::move(name))
+{}
+
+SharedFramePublisher::~SharedFramePublisher() {
+    releaseBuffers();
+}
+
+void SharedFramePublisher::publish(unsigned int texture, ivec2 size,
+                                   uint64_t frameNumber)
+{
+    ZoneScoped;
+
+    const GLsizei bufferSize = size.x * size.y * 4;
+    if (_size.x != size.x || _size.y != size.y) {
+        // Only OpenGL 4.1 is available on macOS, so the buffers are bound for all calls
+        releaseBuffers();
+        glGenBuffers(2, _pbos.data());
+        for (GLuint pbo : _pbos) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, bufferSize, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        _size = size;
+        _next = 0;
+    }
+
+    // The buffer that is used for this frame holds the readback from two frames ago,
+    // which is published first
+    const int i = _next;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbos[i]);
+    if (_fences[i]) {
+        GLsync fence = static_cast<GLsync>(_fences[i]);
+        constexpr GLuint64 Timeout = 1000000000;
+        const GLenum res = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, Timeout);
+        glDeleteSync(fence);
+        _fences[i] = nullptr;
+
+        const void* data =
+            res == GL_WAIT_FAILED ?
+            nullptr :
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bufferSize, GL_MAP_READ_BIT);
+        if (data) {
+            _sender.send(
+                static_cast<const unsigned char*>(data),
+                size,
+                4,
+                1,
+                false,
+                _frameNumbers[i]
+            );
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    _fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _frameNumbers[i] = frameNumber;
+    _next = (i + 1) % 2;
+}
+
+void SharedFramePublisher::releaseBuffers() {
+    for (void*& fence : _fences) {
+        if (fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+            fence = nullptr;
+        }
+    }
+    if (_pbos[0] != 0) {
+        glDeleteBuffers(2, _pbos.data());
+        _pbos = { 0, 0 };
+    }
+    _size = ivec2{ 0, 0 };
+}
+
+SharedFrameReader::SharedFrameReader(std::string name)
+    : _name(objectName(name))
+{
+#ifdef WIN32
+    throw Err(9037, "Shared memory frames are not supported on Windows");
+#endif // WIN32
+}
+
+SharedFrameReader::~SharedFrameReader() {
+    close();
+}
+
+bool SharedFrameReader::read(Image& image) {
+    ZoneScoped;
+
+    if (_mapping && header(_mapping).isStale.load(std::memory_order_acquire)) {
+        close();
+    }
+    if (!_mapping && !open()) {
+        return false;
+    }
+
+    const sharedframe::Header& h = header(_mapping);
+    for (int attempt = 0; attempt < MaxReadAttempts; attempt++) {
+        const uint32_t latest = h.latest.load(std::memory_order_acquire);
+        if (latest >= sharedframe::NumberOfBuffers) {
+            // No frame has been sent yet
+            return false;
+        }
+        const sharedframe::Slot& slot = h.slots[latest];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence % 2 == 1) {
+            continue;
+        }
+
+        const uint64_t frameNumber = slot.frameNumber;
+        if (_hasFrame && frameNumber == _frameNumber) {
+            return false;
+        }
+        const double timestamp = slot.timestamp;
+        const ivec2 size = ivec2{ slot.width, slot.height };
+        const int nChannels = slot.nChannels;
+        const int bytesPerChannel = slot.bytesPerChannel;
+        const bool isFloat = slot.isFloat != 0;
+        const uint64_t offset = slot.offset;
+        const uint64_t frameSize =
+            static_cast<uint64_t>(size.x) * size.y * nChannels * bytesPerChannel;
+        if (frameSize == 0 || frameSize > h.bufferSize || offset + frameSize > _size) {
+            // The values were changed while we read them
+            continue;
+        }
+
+        if (image.size().x != size.x || image.size().y != size.y ||
+            image.channels() != nChannels || image.bytesPerChannel() != bytesPerChannel)
+        {
+            image.setSize(size);
+            image.setChannels(nChannels);
+            image.setBytesPerChannel(bytesPerChannel);
+            image.allocateOrResizeData();
+        }
+        image.setFloatingPoint(isFloat);
+        std::memcpy(image.data(), _mapping + offset, frameSize);
+
+        // The copy has to be finished before the sequence number is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+            _hasFrame = true;
+            _frameNumber = frameNumber;
+            _timestamp = timestamp;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t SharedFrameReader::frameNumber() const {
+    return _frameNumber;
+}
+
+double SharedFrameReader::timestamp() const {
+    return _timestamp;
+}
+
+bool SharedFrameReader::open() {
+#ifdef WIN32
+    return false;
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    _file = shm_open(_name.c_str(), O_RDONLY, 0);
+    if (_file < 0) {
+        return false;
+    }
+
+    // The sender might have created the object but not yet set its size
+    struct stat info = {};
+    if (fstat(_file, &info) != 0 ||
+        static_cast<uint64_t>(info.st_size) < sizeof(sharedframe::Header))
+    {
+        close();
+        return false;
+    }
+    _size = static_cast<uint64_t>(info.st_size);
+    void* mapping = mmap(nullptr, _size, PROT_READ, MAP_SHARED, _file, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        return false;
+    }
+    _mapping = static_cast<const unsigned char*>(mapping);
+
+    // The sender might not have initialized the header yet
+    const sharedframe::Header& h = header(_mapping);
+    if (!hasMagic(h) || h.size != _size) {
+        close();
+        return false;
+    }
+    Log::Debug(std::format("Opened shared memory '{}'", _name));
+    return true;
+#endif // WIN32
+}
+
+void SharedFrameReader::close() {
+#ifndef WIN32
+    if (_mapping) {
+        munmap(const_cast<unsigned char*>(_mapping), _size);
+        _mapping = nullptr;
+    }
+    if (_file >= 0) {
+        ::close(_file);
+        _file = -1;
+    }
+#endif // WIN32
+}
+
+} // namespace sgct
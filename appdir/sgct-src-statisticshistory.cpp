@@ -0,0 +1,121 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/statisticshistory.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+
+namespace sgct {
+
+namespace {
+    constexpr int N = StatisticsHistory::HistoryLength;
+
+    // Returns the index of the value with the nearest rank for the percentile \p p in a
+    // sorted list of \p n values
+    int rank(double p, int n) {
+        const int r = static_cast<int>(std::ceil(p * n)) - 1;
+        return std::clamp(r, 0, n - 1);
+    }
+} // namespace
+
+template <typename Compare>
+void StatisticsHistory::push(ExtremaQueue& queue, uint64_t sequence, Compare compare) {
+    // Values that were replaced can no longer be the minimum or maximum
+    while (queue.count > 0 && queue.sequence[queue.first] + N < _nValues) {
+        queue.first = (queue.first + 1) % N;
+        queue.count--;
+    }
+
+    // Neither can values that were added before a smaller value, or a larger value for
+    // the maximum
+    const double value = _values[sequence % N];
+    while (queue.count > 0) {
+        const int last = (queue.first + queue.count - 1) % N;
+        if (!compare(_values[queue.sequence[last] % N], value)) {
+            break;
+        }
+        queue.count--;
+    }
+
+    queue.sequence[(queue.first + queue.count) % N] = sequence;
+    queue.count++;
+}
+
+void StatisticsHistory::add(double value) {
+    const uint64_t sequence = _nValues;
+    const int index = static_cast<int>(sequence % N);
+    if (_nValues >= N) {
+        _sum -= _values[index];
+    }
+    _values[index] = value;
+    _nValues++;
+
+    if (index == N - 1) {
+        // The running sum is recomputed once per round so that rounding errors do not
+        // accumulate over a long run
+        _sum = std::accumulate(_values.begin(), _values.end(), 0.0);
+    }
+    else {
+        _sum += value;
+    }
+
+    push(_minimum, sequence, std::greater_equal<double>());
+    push(_maximum, sequence, std::less_equal<double>());
+}
+
+int StatisticsHistory::size() const {
+    return static_cast<int>(std::min<uint64_t>(_nValues, N));
+}
+
+double StatisticsHistory::newest() const {
+    return _nValues > 0 ? _values[(_nValues - 1) % N] : 0.0;
+}
+
+double StatisticsHistory::average() const {
+    return _nValues > 0 ? _sum / size() : 0.0;
+}
+
+double StatisticsHistory::min() const {
+    return _minimum.count > 0 ? _values[_minimum.sequence[_minimum.first] % N] : 0.0;
+}
+
+double StatisticsHistory::max() const {
+    return _maximum.count > 0 ? _values[_maximum.sequence[_maximum.first] % N] : 0.0;
+}
+
+double StatisticsHistory::operator[](int i) const {
+    return i >= 0 && i < size() ? _values[(_nValues - 1 - i) % N] : 0.0;
+}
+
+StatisticsHistory::Percentiles StatisticsHistory::percentiles() const {
+    const int n = size();
+    if (n == 0) {
+        return Percentiles();
+    }
+
+    _sorted.assign(_values.begin(), _values.begin() + n);
+    // Each search leaves only smaller values in front of the rank it found, so the next
+    // lower rank only has to be searched among them
+    const int r50 = rank(0.50, n);
+    const int r95 = rank(0.95, n);
+    const int r99 = rank(0.99, n);
+    std::nth_element(_sorted.begin(), _sorted.begin() + r99, _sorted.end());
+    std::nth_element(_sorted.begin(), _sorted.begin() + r95, _sorted.begin() + r99);
+    std::nth_element(_sorted.begin(), _sorted.begin() + r50, _sorted.begin() + r95);
+
+    Percentiles res;
+    res.p50 = _sorted[r50];
+    res.p95 = _sorted[r95];
+    res.p99 = _sorted[r99];
+    return res;
+}
+
+} // namespace sgct
@@ -0,0 +1,212 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/syncdelta.h>
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <zlib.h>
+
+#define Err(code, msg) Error(Error::Component::Network, code, msg)
+
+namespace sgct {
+
+namespace {
+    // Combines the \p data with the data of the \p base frame into \p result. Bytes past
+    // the end of the base frame are copied, so the same function restores the data from
+    // the delta
+    void applyDelta(const std::byte* data, size_t size,
+                    const std::vector<std::byte>& base, std::vector<std::byte>& result)
+    {
+        result.resize(size);
+        const size_t n = std::min(size, base.size());
+        for (size_t i = 0; i < n; i++) {
+            result[i] = data[i] ^ base[i];
+        }
+        std::copy(data + n, data + size, result.begin() + n);
+    }
+} // namespace
+
+SyncDeltaEncoder::SyncDeltaEncoder(int keyframeInterval)
+    : _keyframeInterval(keyframeInterval)
+{}
+
+std::vector<std::byte> SyncDeltaEncoder::encode(const std::vector<std::byte>& data) {
+    ZoneScoped;
+
+    const bool isKeyframe =
+        _isKeyframeRequested || !_hasBase ||
+        (_keyframeInterval > 0 && _sequence % _keyframeInterval == 0);
+    _isKeyframeRequested = false;
+
+    const std::vector<std::byte>* payload = &data;
+    if (!isKeyframe) {
+        applyDelta(data.data(), data.size(), _base, _delta);
+        payload = &_delta;
+    }
+
+    syncdelta::Header header;
+    header.flags = isKeyframe ? syncdelta::Keyframe : 0;
+    header.sequence = _sequence;
+    header.baseSequence = isKeyframe ? _sequence : _baseSequence;
+    header.size = static_cast<uint32_t>(data.size());
+
+    const uLong size = static_cast<uLong>(payload->size());
+    uLongf length = compressBound(size);
+    std::vector<std::byte> message(sizeof(syncdelta::Header) + length);
+    const int res = compress2(
+        reinterpret_cast<Bytef*>(message.data() + sizeof(syncdelta::Header)),
+        &length,
+        reinterpret_cast<const Bytef*>(payload->data()),
+        size,
+        Z_BEST_SPEED
+    );
+    if (res == Z_OK && length < size) {
+        header.flags |= syncdelta::Compressed;
+        header.payloadSize = static_cast<uint32_t>(length);
+    }
+    else {
+        std::copy(
+            payload->begin(),
+            payload->end(),
+            message.begin() + sizeof(syncdelta::Header)
+        );
+        header.payloadSize = static_cast<uint32_t>(size);
+    }
+    message.resize(sizeof(syncdelta::Header) + header.payloadSize);
+    std::memcpy(message.data(), &header, sizeof(syncdelta::Header));
+
+    if (isKeyframe) {
+        // A keyframe is the base for the following frames without being acknowledged,
+        // as the messages arrive in order and it does not depend on an earlier frame.
+        // This lets clients that missed a frame continue with the next message
+        _base = data;
+        _baseSequence = _sequence;
+        _hasBase = true;
+        _hasSent = false;
+    }
+    else {
+        _sent = data;
+        _hasSent = true;
+    }
+    _sequence++;
+    _dataSizes.add(static_cast<double>(data.size()));
+    _messageSizes.add(static_cast<double>(message.size()));
+    return message;
+}
+
+void SyncDeltaEncoder::acknowledge() {
+    if (!_hasSent) {
+        return;
+    }
+    // The buffers are swapped so that the next frame reuses the memory
+    std::swap(_base, _sent);
+    _baseSequence = _sequence - 1;
+    _hasBase = true;
+    _hasSent = false;
+}
+
+void SyncDeltaEncoder::requestKeyframe() {
+    _isKeyframeRequested = true;
+}
+
+const StatisticsHistory& SyncDeltaEncoder::dataSizes() const {
+    return _dataSizes;
+}
+
+const StatisticsHistory& SyncDeltaEncoder::messageSizes() const {
+    return _messageSizes;
+}
+
+bool SyncDeltaDecoder::decode(const std::vector<std::byte>& message,
+                              std::vector<std::byte>& data)
+{
+    ZoneScoped;
+
+    syncdelta::Header header;
+    if (message.size() < sizeof(syncdelta::Header) ||
+        std::memcmp(message.data(), header.magic, sizeof(header.magic)) != 0)
+    {
+        throw Err(5100, "Received synchronization data in an unknown format");
+    }
+    std::memcpy(&header, message.data(), sizeof(syncdelta::Header));
+    if (sizeof(syncdelta::Header) + header.payloadSize > message.size()) {
+        throw Err(
+            5101,
+            std::format(
+                "Synchronization message {} is truncated: {} of {} bytes",
+                header.sequence, message.size(),
+                sizeof(syncdelta::Header) + header.payloadSize
+            )
+        );
+    }
+
+    const bool isKeyframe = (header.flags & syncdelta::Keyframe) != 0;
+    const auto base = std::find_if(
+        _frames.begin(),
+        _frames.end(),
+        [&header](const Frame& f) { return f.sequence == header.baseSequence; }
+    );
+    if (!isKeyframe && base == _frames.end()) {
+        return false;
+    }
+
+    const std::byte* payload = message.data() + sizeof(syncdelta::Header);
+    if (header.flags & syncdelta::Compressed) {
+        _payload.resize(header.size);
+        uLongf length = header.size;
+        const int res = uncompress(
+            reinterpret_cast<Bytef*>(_payload.data()),
+            &length,
+            reinterpret_cast<const Bytef*>(payload),
+            header.payloadSize
+        );
+        if (res != Z_OK || length != header.size) {
+            throw Err(
+                5102,
+                std::format(
+                    "Could not decompress synchronization message {}", header.sequence
+                )
+            );
+        }
+        payload = _payload.data();
+    }
+    else if (header.payloadSize != header.size) {
+        throw Err(
+            5101,
+            std::format(
+                "Synchronization message {} has {} instead of {} bytes",
+                header.sequence, header.payloadSize, header.size
+            )
+        );
+    }
+
+    if (isKeyframe) {
+        data.assign(payload, payload + header.size);
+    }
+    else {
+        applyDelta(payload, header.size, base->data, data);
+    }
+
+    // The master only moves its base forward, so older frames are no longer needed
+    std::erase_if(
+        _frames,
+        [&header](const Frame& f) { return f.sequence < header.baseSequence; }
+    );
+    if (static_cast<int>(_frames.size()) >= MaxFrames) {
+        _frames.pop_front();
+    }
+    _frames.push_back({ header.sequence, data });
+    return true;
+}
+
+} // namespace sgct
@@ -0,0 +1,292 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2026                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/videostream.h>
+
+#include <sgct/error.h>
+#include <sgct/format.h>
+#include <sgct/image.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef __linux__
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
+#elif defined(__APPLE__)
+#include <fcntl.h>
+#endif // __linux__
+
+#define Err(code, msg) Error(Error::Component::Image, code, msg)
+
+namespace sgct {
+
+namespace {
+    // BT.601 with limited range in 8-bit fixed point, which is what encoders assume for
+    // Y4M streams that don't specify the color range
+    unsigned char lumaFromRgb(int r, int g, int b) {
+        const int y = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        return static_cast<unsigned char>(y);
+    }
+
+    unsigned char cbFromRgb(int r, int g, int b) {
+        const int cb = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+        return static_cast<unsigned char>(cb);
+    }
+
+    unsigned char crFromRgb(int r, int g, int b) {
+        const int cr = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+        return static_cast<unsigned char>(cr);
+    }
+
+    void encodeY4mFrame(const Image& image, unsigned char* out) {
+        const int w = image.size().x;
+        const int h = image.size().y;
+        const int cw = (w + 1) / 2;
+        const int ch = (h + 1) / 2;
+        const int nChannels = image.channels();
+        const size_t stride = static_cast<size_t>(w) * nChannels;
+
+        // The image is stored bottom-up, the video is top-down
+        auto row = [&](int y) {
+            return image.data() + static_cast<size_t>(h - 1 - y) * stride;
+        };
+
+        unsigned char* yPlane = out;
+        for (int y = 0; y < h; y++) {
+            const unsigned char* src = row(y);
+            for (int x = 0; x < w; x++) {
+                const unsigned char* p = src + static_cast<size_t>(x) * nChannels;
+                yPlane[x] = lumaFromRgb(p[2], p[1], p[0]);
+            }
+            yPlane += w;
+        }
+
+        // Each chroma sample is computed from the average of a 2x2 block of pixels. For
+        // odd sizes, the last row and column are used twice
+        unsigned char* cbPlane = out + static_cast<size_t>(w) * h;
+        unsigned char* crPlane = cbPlane + static_cast<size_t>(cw) * ch;
+        for (int y = 0; y < ch; y++) {
+            const unsigned char* src0 = row(2 * y);
+            const unsigned char* src1 = row(std::min(2 * y + 1, h - 1));
+            for (int x = 0; x < cw; x++) {
+                const size_t x0 = static_cast<size_t>(2 * x) * nChannels;
+                const size_t x1 =
+                    static_cast<size_t>(std::min(2 * x + 1, w - 1)) * nChannels;
+                const int b = src0[x0] + src0[x1] + src1[x0] + src1[x1];
+                const int g = src0[x0 + 1] + src0[x1 + 1] + src1[x0 + 1] + src1[x1 + 1];
+                const int r = src0[x0 + 2] + src0[x1 + 2] + src1[x0 + 2] + src1[x1 + 2];
+                cbPlane[x] = cbFromRgb((r + 2) / 4, (g + 2) / 4, (b + 2) / 4);
+                crPlane[x] = crFromRgb((r + 2) / 4, (g + 2) / 4, (b + 2) / 4);
+            }
+            cbPlane += cw;
+            crPlane += cw;
+        }
+    }
+
+    void encodeRawRgbFrame(const Image& image, unsigned char* out) {
+        const int w = image.size().x;
+        const int h = image.size().y;
+        const int nChannels = image.channels();
+        const size_t stride = static_cast<size_t>(w) * nChannels;
+
+        for (int y = 0; y < h; y++) {
+            const unsigned char* src =
+                image.data() + static_cast<size_t>(h - 1 - y) * stride;
+            for (int x = 0; x < w; x++) {
+                out[0] = src[2];
+                out[1] = src[1];
+                out[2] = src[0];
+                src += nChannels;
+                out += 3;
+            }
+        }
+    }
+} // namespace
+
+VideoStream::VideoStream(std::string destination, Format format, ivec2 size,
+                         int frameRate)
+    : _destination(std::move(destination))
+    , _format(format)
+    , _size(std::move(size))
+    , _isPipe(!_destination.empty() && _destination.front() == '|')
+{
+    ZoneScoped;
+
+    if (_isPipe) {
+        const std::string command = _destination.substr(1);
+#ifdef WIN32
+        _file = _popen(command.c_str(), "wb");
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        _file = popen(command.c_str(), "w");
+#endif // WIN32
+    }
+    else {
+        _file = std::fopen(_destination.c_str(), "wb");
+    }
+    if (!_file) {
+        throw Err(9030, std::format("Cannot open video stream '{}'", _destination));
+    }
+#ifdef __APPLE__
+    // Writing to a pipe whose reader has exited should fail instead of raising SIGPIPE
+    fcntl(fileno(_file), F_SETNOSIGPIPE, 1);
+#endif // __APPLE__
+
+    if (_format == Format::Y4M) {
+        const std::string header = std::format(
+            "YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg\n", _size.x, _size.y, frameRate
+        );
+        write(reinterpret_cast<const unsigned char*>(header.data()), header.size());
+    }
+    Log::Info(std::format(
+        "Writing {}x{} video stream to '{}'", _size.x, _size.y, _destination
+    ));
+}
+
+VideoStream::~VideoStream() {
+    ZoneScoped;
+
+#ifdef WIN32
+    const int res = _isPipe ? _pclose(_file) : std::fclose(_file);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+    const int res = _isPipe ? pclose(_file) : std::fclose(_file);
+#endif // WIN32
+    if (res != 0) {
+        Log::Warning(std::format(
+            "Closing video stream '{}' returned {}", _destination, res
+        ));
+    }
+    Log::Info(std::format(
+        "Closed video stream '{}' after {} frames", _destination, _nextWritten
+    ));
+}
+
+std::shared_ptr<const uint64_t> VideoStream::reserveFrame() {
+    uint64_t position = 0;
+    {
+        const std::unique_lock lock(_mutex);
+        position = _nextReserved++;
+    }
+    return std::shared_ptr<const uint64_t>(
+        new uint64_t(position),
+        [self = shared_from_this()](const uint64_t* p) {
+            self->skip(*p);
+            delete p;
+        }
+    );
+}
+
+std::vector<unsigned char> VideoStream::encode(const Image& image) const {
+    ZoneScoped;
+
+    if (image.bytesPerChannel() != 1 || image.size().x != _size.x ||
+        image.size().y != _size.y)
+    {
+        throw Err(9031, std::format(
+            "Cannot write {}x{} {}-bit frame to {}x{} video stream '{}'",
+            image.size().x, image.size().y, image.bytesPerChannel() * 8,
+            _size.x, _size.y, _destination
+        ));
+    }
+
+    const size_t nPixels = static_cast<size_t>(_size.x) * _size.y;
+    switch (_format) {
+        case Format::Y4M:
+        {
+            constexpr std::string_view FrameHeader = "FRAME\n";
+            const size_t nChroma = static_cast<size_t>((_size.x + 1) / 2) *
+                ((_size.y + 1) / 2);
+            std::vector<unsigned char> frame(FrameHeader.size() + nPixels + 2 * nChroma);
+            std::memcpy(frame.data(), FrameHeader.data(), FrameHeader.size());
+            encodeY4mFrame(image, frame.data() + FrameHeader.size());
+            return frame;
+        }
+        case Format::RawRGB:
+        {
+            std::vector<unsigned char> frame(3 * nPixels);
+            encodeRawRgbFrame(image, frame.data());
+            return frame;
+        }
+        default:
+            throw std::logic_error("Unhandled case label");
+    }
+}
+
+void VideoStream::submit(uint64_t position, std::vector<unsigned char> frame) {
+    std::unique_lock lock(_mutex);
+    _pending.insert_or_assign(position, std::move(frame));
+    writePending(lock);
+}
+
+void VideoStream::skip(uint64_t position) {
+    std::unique_lock lock(_mutex);
+    if (position < _nextWritten || _pending.contains(position)) {
+        // The frame has already been submitted
+        return;
+    }
+    Log::Debug(std::format(
+        "Skipping frame {} of video stream '{}'", position, _destination
+    ));
+    _pending.emplace(position, std::vector<unsigned char>());
+    writePending(lock);
+}
+
+void VideoStream::writePending(std::unique_lock<std::mutex>& lock) {
+    // Only one thread writes at a time. The others only add their frames, which the
+    // writing thread picks up before it returns
+    while (!_isWriting && !_pending.empty() && _pending.begin()->first == _nextWritten) {
+        _isWriting = true;
+        auto node = _pending.extract(_pending.begin());
+
+        lock.unlock();
+        if (!node.mapped().empty() && !_hasFailed) {
+            write(node.mapped().data(), node.mapped().size());
+        }
+        node = {};
+        lock.lock();
+
+        _isWriting = false;
+        _nextWritten++;
+    }
+}
+
+void VideoStream::write(const unsigned char* data, size_t size) {
+    ZoneScoped;
+
+#ifdef __linux__
+    // If the receiving process has exited, the write raises SIGPIPE, which would
+    // terminate the application. The signal is blocked for this thread and consumed if
+    // it was raised
+    sigset_t pipeSignal;
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+    sigset_t oldMask;
+    pthread_sigmask(SIG_BLOCK, &pipeSignal, &oldMask);
+#endif // __linux__
+
+    const size_t written = std::fwrite(data, 1, size, _file);
+
+#ifdef __linux__
+    if (written != size) {
+        const timespec noWait = { 0, 0 };
+        sigtimedwait(&pipeSignal, nullptr, &noWait);
+    }
+    pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+#endif // __linux__
+
+    if (written != size) {
+        // All following frames are discarded as the stream is broken anyway
+        _hasFailed = true;
+        Log::Error(std::format("Error writing to video stream '{}'", _destination));
+    }
+}
+
+} // namespace sgct